@@ -0,0 +1,119 @@
+/**
+ * @file sporadic_bench.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief CPU share of a sporadic server created from main, on the board
+ *
+ * Built in place of rtos_main.c, with RTOS_ENABLE_SPORADIC_SERVER. The
+ * server and a lower priority worker are created before the scheduler
+ * starts, and both spin on the same loop forever. The server may only
+ * run its capacity per period at its priority, the rest of the time it
+ * is demoted below the worker, so its share of the loops must match
+ * capacity / period. A reporter prints both counts every second.
+ */
+
+#include "board.h"
+#include "pin_mux.h"
+#include "clock_config.h"
+#include "fsl_debug_console.h"
+
+#include "rtos.h"
+#include "rtos_config.h"
+
+#ifndef RTOS_ENABLE_SPORADIC_SERVER
+#error "sporadic_bench needs RTOS_ENABLE_SPORADIC_SERVER"
+#endif
+
+/**********************************************************************************/
+// Bench settings
+/**********************************************************************************/
+
+#define SERVER_PRIORITY		3
+#define SERVER_CAPACITY		20		//ticks
+#define SERVER_PERIOD		100		//ticks
+#define WORKER_PRIORITY		2		//above the background priority of a demoted server
+#define REPORTER_PRIORITY	4
+#define REPORT_TICKS		(1000000 / RTOS_TIC_PERIOD_IN_US)
+#define REPORTS				10
+#define SHARE_TOLERANCE		20		//per mille
+
+/**********************************************************************************/
+// Bench data
+/**********************************************************************************/
+
+static volatile uint32_t server_loops;
+static volatile uint32_t worker_loops;
+
+/**********************************************************************************/
+// Local methods
+/**********************************************************************************/
+
+static void server_task ( void )
+{
+	for ( ;; )
+	{
+		server_loops++;
+	}
+}
+
+static void worker_task ( void )
+{
+	for ( ;; )
+	{
+		worker_loops++;
+	}
+}
+
+static void reporter_task ( void )
+{
+	uint32_t expected = 1000 * SERVER_CAPACITY / SERVER_PERIOD;
+	uint32_t failed = 0;
+	for ( uint32_t report = 0; report < REPORTS; report++ )
+	{
+		uint32_t server;
+		uint32_t worker;
+		uint32_t share;
+		server_loops = 0;
+		worker_loops = 0;
+		rtos_delay ( REPORT_TICKS );
+		server = server_loops;
+		worker = worker_loops;
+		share = ( uint32_t ) ( ( uint64_t ) 1000 * server
+				/ ( server + worker ? server + worker : 1 ) );
+		if (share + SHARE_TOLERANCE < expected
+				|| share > expected + SHARE_TOLERANCE)
+		{
+			failed++;
+		}
+		PRINTF ( "server %u loops, worker %u loops, share %u of %u per mille\r\n",
+				server, worker, share, expected );
+	}
+	PRINTF ( "%u of %u reports out of tolerance\r\n", failed, REPORTS );
+	for ( ;; )
+	{
+		rtos_suspend_task ();
+	}
+}
+
+/**********************************************************************************/
+// Main
+/**********************************************************************************/
+
+int main ( void )
+{
+	BOARD_InitPins ();
+	BOARD_BootClockRUN ();
+	BOARD_InitDebugConsole ();
+
+	//before the scheduler starts, the capacity is scaled once the SysTick is set
+	rtos_create_sporadic_server ( server_task, SERVER_PRIORITY,
+			SERVER_CAPACITY, SERVER_PERIOD, kAutoStart );
+	rtos_create_task ( worker_task, WORKER_PRIORITY, kAutoStart );
+	rtos_create_task ( reporter_task, REPORTER_PRIORITY, kAutoStart );
+	rtos_start_scheduler ();
+
+	for ( ;; )
+	{
+		__asm("NOP");
+	}
+}
@@ -0,0 +1,141 @@
+/**
+ * @file task_churn_bench.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Create and delete throughput of the rtos tasks, on the board
+ *
+ * Built in place of rtos_main.c. A task creates and deletes workers
+ * in three ways: suspended workers deleted by it, workers that run and
+ * return, and a full TCB table emptied again. It checks every stale
+ * handle is rejected and prints the cycles per operation.
+ */
+
+#include "board.h"
+#include "pin_mux.h"
+#include "clock_config.h"
+#include "fsl_debug_console.h"
+
+#include "rtos.h"
+#include "rtos_config.h"
+
+/**********************************************************************************/
+// Bench settings
+/**********************************************************************************/
+
+#define CHURN_ROUNDS		1000
+#define BENCH_PRIORITY		2
+#define WORKER_PRIORITY		3	//workers preempt the bench as soon as they are ready
+
+/**********************************************************************************/
+// Bench data
+/**********************************************************************************/
+
+static volatile uint32_t worker_runs;
+static uint32_t stale_accepted;
+static rtos_task_handle_t table [ RTOS_MAX_NUMBER_OF_TASKS ];
+
+/**********************************************************************************/
+// Local methods
+/**********************************************************************************/
+
+static void idle_worker ( void )
+{
+	for ( ;; )
+	{
+		rtos_suspend_task ();
+	}
+}
+
+//returns right away, so it is deleted by the kernel
+static void short_worker ( void )
+{
+	worker_runs++;
+}
+
+static void check_stale ( rtos_task_handle_t task )
+{
+	if (rtos_delete_task ( task ) || rtos_get_stack_high_water ( task ))
+	{
+		stale_accepted++;
+	}
+}
+
+static void report ( const char *name, uint64_t cycles, uint32_t operations )
+{
+	PRINTF ( "%s: %u cycles per operation\r\n", name,
+			( uint32_t ) ( cycles / operations ) );
+}
+
+static void bench_task ( void )
+{
+	uint64_t start;
+	uint32_t created = 0;
+
+	//create and delete of a suspended task, the same slot is reused each round
+	start = rtos_get_cycles ();
+	for ( uint32_t round = 0; round < CHURN_ROUNDS; round++ )
+	{
+		rtos_task_handle_t task = rtos_create_task ( idle_worker,
+				WORKER_PRIORITY, kStartSuspended );
+		rtos_delete_task ( task );
+		check_stale ( task );
+	}
+	report ( "create + delete", rtos_get_cycles () - start, CHURN_ROUNDS );
+
+	//create, run to completion and self deletion, two context switches per round
+	worker_runs = 0;
+	start = rtos_get_cycles ();
+	for ( uint32_t round = 0; round < CHURN_ROUNDS; round++ )
+	{
+		rtos_task_handle_t task = rtos_create_task ( short_worker,
+				WORKER_PRIORITY, kAutoStart );
+		rtos_activate_task ( task );
+		check_stale ( task );
+	}
+	report ( "create + run + exit", rtos_get_cycles () - start,
+			CHURN_ROUNDS );
+
+	//the whole table, the free list must give every slot back
+	start = rtos_get_cycles ();
+	while (created < RTOS_MAX_NUMBER_OF_TASKS)
+	{
+		table [ created ] = rtos_create_task ( idle_worker, WORKER_PRIORITY,
+				kStartSuspended );
+		if (0 > table [ created ])
+		{
+			break;
+		}
+		created++;
+	}
+	for ( uint32_t task = 0; task < created; task++ )
+	{
+		rtos_delete_task ( table [ task ] );
+	}
+	report ( "fill + empty", rtos_get_cycles () - start, 2 * created );
+
+	PRINTF ( "%u workers run, %u free slots, %u stale handles accepted\r\n",
+			worker_runs, created, stale_accepted );
+	for ( ;; )
+	{
+		rtos_suspend_task ();
+	}
+}
+
+/**********************************************************************************/
+// Main
+/**********************************************************************************/
+
+int main ( void )
+{
+	BOARD_InitPins ();
+	BOARD_BootClockRUN ();
+	BOARD_InitDebugConsole ();
+
+	rtos_create_task ( bench_task, BENCH_PRIORITY, kAutoStart );
+	rtos_start_scheduler ();
+
+	for ( ;; )
+	{
+		__asm("NOP");
+	}
+}
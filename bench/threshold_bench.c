@@ -0,0 +1,142 @@
+/**
+ * @file threshold_bench.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Context switches saved by the preemption thresholds, on the board
+ *
+ * Built in place of rtos_main.c, with RTOS_ENABLE_PREEMPTION_THRESHOLD.
+ * Each round the bench task starts a chain of three workers, each one
+ * activates the next, higher priority, one in the middle of its job.
+ * The rounds run first with the thresholds equal to the priorities,
+ * where every activation preempts, and then with the three workers
+ * sharing the threshold of the highest one, where each job runs to its
+ * end. It prints the context switches and cycles per round of both.
+ */
+
+#include "board.h"
+#include "pin_mux.h"
+#include "clock_config.h"
+#include "fsl_debug_console.h"
+
+#include "rtos.h"
+#include "rtos_config.h"
+
+#ifndef RTOS_ENABLE_PREEMPTION_THRESHOLD
+#error "threshold_bench needs RTOS_ENABLE_PREEMPTION_THRESHOLD"
+#endif
+
+/**********************************************************************************/
+// Bench settings
+/**********************************************************************************/
+
+#define THRESHOLD_ROUNDS	1000
+#define JOB_LOOPS			200		//half of the job of a worker
+#define BENCH_PRIORITY		1		//below the workers, it resumes once the chain ends
+#define WORKERS				3
+#define WORKER_PRIORITY		2		//of the first worker, the next ones are one above
+
+/**********************************************************************************/
+// Bench data
+/**********************************************************************************/
+
+static rtos_task_handle_t workers [ WORKERS ];
+static volatile uint32_t jobs;
+
+/**********************************************************************************/
+// Local methods
+/**********************************************************************************/
+
+static void job ( void )
+{
+	volatile uint32_t sink = 0;
+	for ( uint32_t loop = 0; loop < JOB_LOOPS; loop++ )
+	{
+		sink += loop;
+	}
+}
+
+static void worker ( uint8_t stage )
+{
+	for ( ;; )
+	{
+		job ();
+		if (stage + 1 < WORKERS)
+		{
+			rtos_activate_task ( workers [ stage + 1 ] );
+		}
+		job ();
+		jobs++;
+		rtos_suspend_task ();
+	}
+}
+
+static void first_worker ( void )
+{
+	worker ( 0 );
+}
+
+static void second_worker ( void )
+{
+	worker ( 1 );
+}
+
+static void third_worker ( void )
+{
+	worker ( 2 );
+}
+
+static void run_rounds ( const char *name )
+{
+	uint32_t switches = rtos_get_context_switches ();
+	uint64_t start = rtos_get_cycles ();
+	for ( uint32_t round = 0; round < THRESHOLD_ROUNDS; round++ )
+	{
+		//the chain runs above the bench, it is back once the last worker suspends
+		rtos_activate_task ( workers [ 0 ] );
+	}
+	PRINTF ( "%s: %u context switches, %u cycles per round\r\n", name,
+			( rtos_get_context_switches () - switches ) / THRESHOLD_ROUNDS,
+			( uint32_t ) ( ( rtos_get_cycles () - start ) / THRESHOLD_ROUNDS ) );
+}
+
+static void bench_task ( void )
+{
+	run_rounds ( "thresholds at the priorities" );
+	for ( uint8_t stage = 0; stage < WORKERS; stage++ )
+	{
+		rtos_set_preemption_threshold ( workers [ stage ],
+				WORKER_PRIORITY + WORKERS - 1 );
+	}
+	run_rounds ( "shared threshold" );
+
+	PRINTF ( "%u jobs of %u\r\n", jobs, 2 * WORKERS * THRESHOLD_ROUNDS );
+	for ( ;; )
+	{
+		rtos_suspend_task ();
+	}
+}
+
+/**********************************************************************************/
+// Main
+/**********************************************************************************/
+
+int main ( void )
+{
+	BOARD_InitPins ();
+	BOARD_BootClockRUN ();
+	BOARD_InitDebugConsole ();
+
+	workers [ 0 ] = rtos_create_task ( first_worker, WORKER_PRIORITY,
+			kStartSuspended );
+	workers [ 1 ] = rtos_create_task ( second_worker, WORKER_PRIORITY + 1,
+			kStartSuspended );
+	workers [ 2 ] = rtos_create_task ( third_worker, WORKER_PRIORITY + 2,
+			kStartSuspended );
+	rtos_create_task ( bench_task, BENCH_PRIORITY, kAutoStart );
+	rtos_start_scheduler ();
+
+	for ( ;; )
+	{
+		__asm("NOP");
+	}
+}
@@ -10,7 +10,14 @@
 
 #include "rtos.h"
 #include "rtos_config.h"
+#include "rtos_kernel.h"
 #include "clock_config.h"
+#if RTOS_NUMBER_OF_CORES > 1
+#include "rtos_smp.h"
+#endif
+#ifdef RTOS_ENABLE_BASIC_TASKS
+#include "rtos_basic.h"
+#endif
 
 #ifdef RTOS_ENABLE_IS_ALIVE
 #include "fsl_gpio.h"
@@ -20,13 +27,101 @@
 // Module defines
 /**********************************************************************************/
 
-#define FORCE_INLINE 	__attribute__((always_inline)) inline
-
-#define STACK_FRAME_SIZE			8
+#define STACK_FRAME_SIZE			8	//r0-r3, r12, lr, pc and xpsr stacked by the core
+#define STACK_SW_FRAME_SIZE			9	//r4-r11 and EXC_RETURN stacked by PendSV
+#define STACK_FP_SW_FRAME_SIZE		16	//s16-s31 stacked by PendSV for the tasks using the FPU
+#if defined(__FPU_USED) && __FPU_USED
+#define CORE_CONTEXT_SIZE			(STACK_SW_FRAME_SIZE + STACK_FP_SW_FRAME_SIZE)	//main may have used the FPU
+#else
+#define CORE_CONTEXT_SIZE			STACK_SW_FRAME_SIZE
+#endif
 #define STACK_PC_OFFSET				2
+#define STACK_LR_OFFSET				3
 #define STACK_PSR_OFFSET			1
+#define STACK_EXC_RETURN_OFFSET		(STACK_FRAME_SIZE + 1)
 #define STACK_PSR_DEFAULT			0x01000000
+#define STACK_PAINT					0xA5A5A5A5
+#define EXC_RETURN_THREAD_PSP		0xFFFFFFFD
 #define INVALID_TASK				-1
+#define LOCAL_TICK_FOREVER			UINT32_MAX	//RTOS_WAIT_FOREVER of the 32 bits countdowns
+#define HANDLE_INDEX_MASK			0x3F	//TCB slot, the bits above are RTOS_BASIC_TASK_FLAG
+#define HANDLE_GENERATION_SHIFT		8
+#define HANDLE_GENERATION_MASK		0x7F	//a stale handle is missed after 128 reuses of its slot
+#if RTOS_MAX_NUMBER_OF_TASKS > HANDLE_INDEX_MASK + 1
+#error "RTOS_MAX_NUMBER_OF_TASKS does not fit in the task handles"
+#endif
+#define JOB_IDLE					0	//the job states of the timing statistics
+#define JOB_RELEASED				1
+#define JOB_STARTED					2
+
+#if RTOS_NUMBER_OF_CORES > 1
+#define CURRENT_TASK				task_list.current_task [ rtos_port_core_id () ]
+#define NO_CORE						0xFF
+#else
+#define CURRENT_TASK				task_list.current_task
+#endif
+
+#if defined(RTOS_ENABLE_CPU_BUDGET) && RTOS_NUMBER_OF_CORES > 1
+#error "RTOS_ENABLE_CPU_BUDGET supports a single core"
+#endif
+#define BACKGROUND_PRIORITY			0	//of the demoted tasks, the idle task only runs below it
+
+#define STACK_ALIGNMENT				RTOS_STACK_ALIGNMENT(RTOS_STACK_SIZE)
+#if RTOS_KERNEL_STACKS > RTOS_MAX_NUMBER_OF_TASKS
+#error "RTOS_KERNEL_STACKS can not exceed RTOS_MAX_NUMBER_OF_TASKS"
+#endif
+
+/**********************************************************************************/
+// MPU definitions
+/**********************************************************************************/
+
+#ifdef RTOS_ENABLE_MPU_STACK_GUARD
+#if !defined(__MPU_PRESENT) || !__MPU_PRESENT
+#error "RTOS_ENABLE_MPU_STACK_GUARD needs a core with the ARMv7-M MPU"
+#endif
+#ifdef RTOS_ENABLE_STACK_CHECK
+#error "RTOS_ENABLE_MPU_STACK_GUARD replaces RTOS_ENABLE_STACK_CHECK"
+#endif
+#define MPU_BACKGROUND_REGION		0	//code and RAM, read only when unprivileged
+#define MPU_STACK_REGION			1	//stack of the running task
+#define MPU_GUARD_REGION			2	//no access band below the stack
+#define MPU_GUARD_SIZE				32
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+#if (RTOS_STACK_SIZE * 4) & (RTOS_STACK_SIZE * 4 - 1)
+#error "RTOS_ENABLE_UNPRIVILEGED_TASKS needs RTOS_STACK_SIZE words to be a power of two bytes"
+#endif
+#define SVC_SUSPEND_TASK			0
+#define SVC_ACTIVATE_TASK			1
+#define SVC_DELAY					2
+#define SVC_DELETE_TASK				3
+#define SVC_GET_CYCLES				4
+#define SVC_GET_TIME_NS				5
+//Unprivileged tasks cannot reach the kernel data nor the PendSV, so the API
+//traps into the SVC_Handler, which calls it back privileged
+#define SYSCALL(number, arg0, arg1)													\
+	do																				\
+	{																				\
+		register uint32_t r0 asm("r0") = ( arg0 );									\
+		register uint32_t r1 asm("r1") = ( arg1 );									\
+		asm volatile ( "svc %[svc]" : "+r" (r0) : [svc] "i" (number), "r" (r1)	\
+				: "memory" );														\
+	} while (0)
+//Same for the calls returning 64 bits, the gate leaves them in the stacked r0 and r1
+#define SYSCALL_RESULT(number, result)												\
+	do																				\
+	{																				\
+		register uint32_t r0 asm("r0") = 0;											\
+		register uint32_t r1 asm("r1") = 0;											\
+		asm volatile ( "svc %[svc]" : "+r" (r0), "+r" (r1) : [svc] "i" (number)	\
+				: "memory" );														\
+		result = r0 | ( ( uint64_t ) r1 << 32 );									\
+	} while (0)
+#endif
+static void
+init_mpu ( void );
+static void
+set_mpu_regions ( rtos_task_handle_t task );
+#endif
 
 /**********************************************************************************/
 // IS ALIVE definitions
@@ -37,6 +132,7 @@
 #define alive_GPIO(x)			CAT_STRING(GPIO,x)
 #define alive_PORT(x)			CAT_STRING(PORT,x)
 #define alive_CLOCK(x)			CAT_STRING(kCLOCK_Port,x)
+#define IS_ALIVE_PERIOD_IN_TICKS	(RTOS_IS_ALIVE_PERIOD_IN_US / RTOS_TIC_PERIOD_IN_US)
 static void
 init_is_alive ( void );
 static void
@@ -49,53 +145,178 @@ refresh_is_alive ( void );
 
 typedef enum
 {
-	S_READY = 0, S_RUNNING, S_WAITING, S_SUSPENDED
+	S_READY = 0, S_RUNNING, S_WAITING, S_SUSPENDED, S_BLOCKED, S_DELETED
 } task_state_e;
-typedef enum
-{
-	kFromISR = 0, kFromNormalExec
-} task_switch_type_e;
-
 typedef struct
 {
 	uint8_t priority;
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+	uint8_t preemption_threshold;	//priority a task must exceed to preempt this one
+	uint8_t preempted;	//1 while it waits for the core it lost runnable, at its threshold
+#endif
 	task_state_e state;
-	uint32_t *sp;	//pointer to the stack end obtained from the PendSV_handler
+	uint32_t *sp;	//stack pointer saved by the PendSV_Handler
 	void
 	(*task_body) ( );
-	rtos_tick_t local_tick;
-	uint32_t reserved [ 10 ];//saving space for debugging, may be deleted later (it must remain empty, else, something is wrong)
-	uint32_t stack [ RTOS_STACK_SIZE ];
+	uint32_t local_tick;	//ticks left of the wait, LOCAL_TICK_FOREVER never expires
+	void *wait_object;	//kernel object the task is blocked on
+	uint8_t wait_result;	//1 if woken by rtos_kernel_wake, 0 on timeout
+	uint8_t generation;	//tags the handles of the slot, bumped on each deletion
+	rtos_task_handle_t next_free;	//next slot of the free list
+#ifdef RTOS_ENABLE_HEAP
+	uint32_t heap_bytes;	//heap bytes allocated by the task
+#endif
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+	uint8_t unprivileged;
+#endif
+#ifdef RTOS_ENABLE_CPU_BUDGET
+	rtos_tick_t budget_ticks;	//ticks the task may run per period, 0 without limit
+	uint32_t budget;	//the same in SysTick counts of the current reload
+	uint32_t budget_used;
+	rtos_tick_t budget_period;
+	rtos_tick_t budget_replenish;	//tick the budget is given back
+	rtos_budget_action_e budget_action;
+	uint8_t throttled;
+	uint8_t base_priority;	//priority given back after a demotion
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+	uint8_t base_threshold;
+#endif
+#ifdef RTOS_ENABLE_SPORADIC_SERVER
+	uint8_t sporadic;
+	uint8_t sporadic_active;	//1 during a busy interval at its priority
+	uint8_t nReplenishments;
+	uint32_t sporadic_used;	//budget used when the busy interval started
+	rtos_tick_t sporadic_start;
+	struct
+	{
+		rtos_tick_t tick;
+		uint32_t amount;
+	} replenishments [ RTOS_SPORADIC_REPLENISHMENTS ];	//by tick
+#endif
+#endif
+#ifdef RTOS_ENABLE_TIMING_STATS
+	rtos_tick_t deadline_ticks;	//ticks from release to deadline, 0 without statistics
+	uint32_t deadline;	//the same in cycles, a SysTick count is one core cycle
+	uint8_t job_state;
+	rtos_task_timing_t timing;
+	uint64_t response_sum;
+	uint32_t min_start_latency;
+	uint32_t max_start_latency;
+#endif
+	uint32_t *stack;	//lowest word, the RTOS_STACK_GUARD_WORDS below must keep the STACK_PAINT pattern
+	uint32_t stack_words;
+	int8_t kernel_stack;	//kernel stack the task runs on, -1 on a stack of the caller
 } rtos_tcb_t;
 
+/**********************************************************************************/
+// Kernel stacks
+/**********************************************************************************/
+
+//Taken by rtos_create_task, the tasks created on a stack of their own leave them
+static struct
+{
+	uint32_t guard [ RTOS_STACK_GUARD_WORDS ];
+	uint32_t stack [ RTOS_STACK_SIZE ] __attribute__((aligned(STACK_ALIGNMENT)));
+} kernel_stacks [ RTOS_KERNEL_STACKS ];
+
 /**********************************************************************************/
 // Global (static) task list
 /**********************************************************************************/
 
 struct
 {
-	uint8_t nTasks;
+	uint8_t nTasks;	//slots ever used, the deleted ones go to the free list
+	rtos_task_handle_t free_slot;
+#if RTOS_NUMBER_OF_CORES > 1
+	rtos_task_handle_t current_task [ RTOS_NUMBER_OF_CORES ];
+#else
 	rtos_task_handle_t current_task;
 	rtos_task_handle_t next_task;
+	rtos_task_handle_t idle;	//chosen only when no other task is ready
+#endif
 	rtos_tcb_t tasks [ RTOS_MAX_NUMBER_OF_TASKS + 1 ];
-	rtos_tick_t global_tick;
+	uint8_t stack_used [ RTOS_KERNEL_STACKS ];
+	rtos_tick_t global_tick;	//only SysTick and the critical sections read it directly
+	volatile uint32_t tick_sequence;	//its parity selects the copy readers take
+	volatile rtos_tick_t tick_copies [ 2 ];
+	uint32_t context_switches;
+	uint64_t ns_per_count;	//nanoseconds per SysTick count, in Q32
+	uint8_t started;	//nothing is dispatched before the scheduler starts
+#ifdef RTOS_ENABLE_CPU_BUDGET
+	uint32_t slice_start;	//SysTick counts of the tick already charged
+#endif
 } task_list =
-{ 0 };
+#if RTOS_NUMBER_OF_CORES > 1
+{ .free_slot = INVALID_TASK, .current_task =
+{ [ 0 ... RTOS_NUMBER_OF_CORES - 1 ] = INVALID_TASK } };
+#else
+{ .free_slot = INVALID_TASK, .current_task = INVALID_TASK, .next_task =
+		INVALID_TASK, .idle = INVALID_TASK };
+#endif
 
 /**********************************************************************************/
 // Local methods prototypes
 /**********************************************************************************/
 
+static inline rtos_task_handle_t
+task_handle ( rtos_task_handle_t index );
+static rtos_task_handle_t
+task_index ( rtos_task_handle_t task );
+static rtos_task_handle_t
+allocate_slot ( void );
+static void
+release_slot ( rtos_task_handle_t index );
+static int8_t
+allocate_stack ( void );
+static rtos_task_handle_t
+create_task ( void (*task_body) ( ), uint8_t priority,
+		rtos_autostart_e autostart, uint32_t *stack, uint32_t words );
+static uint8_t
+task_running ( rtos_task_handle_t index );
+static void
+task_exit ( void );
+static void
+advance_tick ( void );
+static inline uint32_t
+to_local_tick ( rtos_tick_t ticks );
 static void
-reload_systick ( void );
+read_timebase ( rtos_tick_t *tick, uint32_t *counts );
 static void
-dispatcher ( task_switch_type_e type );
+init_core ( void );
+static void
+make_ready ( rtos_task_handle_t task );
+static void
+dispatcher ( void );
+static void
+scale_to_counts ( rtos_tcb_t *tcb );
 static void
 activate_waiting_tasks ( );
-FORCE_INLINE static void
-context_switch ( task_switch_type_e type );
+static uint32_t *
+context_switch ( uint32_t *sp ) __attribute__((used));
+#ifdef RTOS_ENABLE_STACK_CHECK
+static void
+check_stack ( rtos_task_handle_t task );
+#endif
 static void
 idle_task ( void );
+#ifdef RTOS_ENABLE_TIMING_STATS
+static void
+job_release ( rtos_task_handle_t task );
+static void
+job_start ( rtos_task_handle_t task );
+static void
+job_complete ( rtos_task_handle_t task );
+#endif
+#ifdef RTOS_ENABLE_CPU_BUDGET
+static void
+charge_budget ( uint32_t now );
+static void
+enforce_budgets ( void );
+#ifdef RTOS_ENABLE_SPORADIC_SERVER
+static void
+sporadic_budget ( rtos_task_handle_t index );
+#endif
+#endif
 
 /**********************************************************************************/
 // API implementation
@@ -105,13 +326,35 @@ void rtos_start_scheduler ( void )
 {
 #ifdef RTOS_ENABLE_IS_ALIVE
 	init_is_alive ();
+#endif
 	task_list.global_tick = 0;
-	task_list.current_task = INVALID_TASK;
-	rtos_create_task ( idle_task, 0, kAutoStart );
+#if RTOS_NUMBER_OF_CORES > 1
+	//one idle task pinned to each core, so a core always has something to run
+	for ( uint8_t core = 0; core < RTOS_NUMBER_OF_CORES; core++ )
+	{
+		rtos_set_task_affinity ( rtos_create_task ( idle_task, 0, kAutoStart ),
+				( rtos_affinity_t ) 1 << core );
+	}
+#else
+	task_list.idle = task_index ( rtos_create_task ( idle_task, 0,
+			kAutoStart ) );
+#endif
+#ifdef RTOS_ENABLE_SOFTWARE_TIMERS
+	rtos_timer_service_init ();
+#endif
+#ifdef RTOS_ENABLE_DEFERRED_ISR
+	rtos_deferred_service_init ();
+#endif
+#ifdef RTOS_ENABLE_WORK_QUEUE
+	rtos_work_queue_init ();
 #endif
+	init_core ();
+	//the SysTick reloads itself, it is only set up again when the core clock changes
+	rtos_update_systick ();
+	task_list.started = 1;
+	SysTick->VAL = 0;
 	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk
 			| SysTick_CTRL_ENABLE_Msk;
-	reload_systick ();
 	for ( ;; )
 		;
 }
@@ -119,202 +362,1488 @@ void rtos_start_scheduler ( void )
 rtos_task_handle_t rtos_create_task ( void (*task_body) ( ), uint8_t priority,
 		rtos_autostart_e autostart )
 {
-	rtos_task_handle_t retval = INVALID_TASK;
-	if (RTOS_MAX_NUMBER_OF_TASKS > task_list.nTasks)
-	{
-		task_list.tasks [ task_list.nTasks ].priority = priority;
-		task_list.tasks [ task_list.nTasks ].local_tick = 0;
-		task_list.tasks [ task_list.nTasks ].task_body = task_body;
-		task_list.tasks [ task_list.nTasks ].sp =
-				& ( task_list.tasks [ task_list.nTasks ].stack [ RTOS_STACK_SIZE
-						- 1 - STACK_FRAME_SIZE ] );	//stack is used bottoms up
-		task_list.tasks [ task_list.nTasks ].state =
-				kStartSuspended == autostart ? S_SUSPENDED : S_READY;
-		task_list.tasks [ task_list.nTasks ].stack [ RTOS_STACK_SIZE
-				- STACK_PC_OFFSET ] = ( uint32_t ) task_body;
-		task_list.tasks [ task_list.nTasks ].stack [ RTOS_STACK_SIZE
-				- STACK_PSR_OFFSET ] =
-		STACK_PSR_DEFAULT;
-		retval = task_list.nTasks;
-		task_list.nTasks++;
+	return create_task ( task_body, priority, autostart, 0, RTOS_STACK_SIZE );
+}
+
+rtos_task_handle_t rtos_create_static_task ( void (*task_body) ( ),
+		uint8_t priority, rtos_autostart_e autostart, uint32_t *stack,
+		uint32_t words )
+{
+	//the MPU regions are aligned to their size, and with unprivileged tasks they cover the stack
+	if (!stack || RTOS_STACK_MIN_WORDS > words
+			|| ( uint32_t ) stack % RTOS_STACK_ALIGNMENT(words)
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+			|| ( words & ( words - 1 ) )
+#endif
+	)
+	{
+		return INVALID_TASK;
+	}
+	return create_task ( task_body, priority, autostart, stack, words );
+}
 
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+rtos_task_handle_t rtos_create_unprivileged_task ( void (*task_body) ( ),
+		uint8_t priority, rtos_autostart_e autostart )
+{
+	rtos_task_handle_t retval = rtos_create_task ( task_body, priority,
+			autostart );
+	if (INVALID_TASK != retval)
+	{
+		task_list.tasks [ task_index ( retval ) ].unprivileged = 1;
 	}
 	return retval;
 }
 
+static inline uint8_t caller_unprivileged ( void )
+{
+	return !__get_IPSR () && ( __get_CONTROL () & CONTROL_nPRIV_Msk );
+}
+#endif
+
 rtos_tick_t rtos_get_clock ( void )
 {
-	return task_list.global_tick;
+	uint32_t sequence;
+	rtos_tick_t tick;
+	do
+	{
+		sequence = task_list.tick_sequence;
+		__DMB ();
+		tick = task_list.tick_copies [ sequence & 1 ];
+		__DMB ();
+	} while (sequence != task_list.tick_sequence);
+	return tick;
+}
+
+uint32_t rtos_get_clock32 ( void )
+{
+	//the low word, little endian, is one aligned load that can not be torn
+	return *( volatile uint32_t* ) &task_list.global_tick;
+}
+
+uint64_t rtos_get_cycles ( void )
+{
+	rtos_tick_t tick;
+	uint32_t counts;
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+	//the SysTick is in the private peripheral bus, out of reach unprivileged
+	if (caller_unprivileged ())
+	{
+		uint64_t cycles;
+		SYSCALL_RESULT( SVC_GET_CYCLES, cycles );
+		return cycles;
+	}
+#endif
+	read_timebase ( &tick, &counts );
+	return tick * ( SysTick->LOAD + 1 ) + counts;
+}
+
+uint64_t rtos_get_time_ns ( void )
+{
+	rtos_tick_t tick;
+	uint32_t counts;
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+	if (caller_unprivileged ())
+	{
+		uint64_t time;
+		SYSCALL_RESULT( SVC_GET_TIME_NS, time );
+		return time;
+	}
+#endif
+	read_timebase ( &tick, &counts );
+	return tick * RTOS_TIC_PERIOD_IN_US * 1000
+			+ ( ( counts * task_list.ns_per_count ) >> 32 );
 }
 
 void rtos_delay ( rtos_tick_t ticks )
 {
-	task_list.tasks [ task_list.current_task ].state = S_WAITING;
-	task_list.tasks [ task_list.current_task ].local_tick = ticks;
-	dispatcher ( kFromNormalExec );
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+	if (caller_unprivileged ())
+	{
+		SYSCALL( SVC_DELAY, ( uint32_t ) ticks, ( uint32_t ) ( ticks >> 32 ) );
+		return;
+	}
+#endif
+#ifdef RTOS_ENABLE_TIMING_STATS
+	job_complete ( CURRENT_TASK );
+#endif
+	task_list.tasks [ CURRENT_TASK ].state = S_WAITING;
+	task_list.tasks [ CURRENT_TASK ].local_tick = to_local_tick ( ticks );
+	dispatcher ();
 }
 
 void rtos_suspend_task ( void )
 {
-	task_list.tasks [ task_list.current_task ].state = S_SUSPENDED;
-	dispatcher ( kFromNormalExec );
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+	if (caller_unprivileged ())
+	{
+		SYSCALL( SVC_SUSPEND_TASK, 0, 0 );
+		return;
+	}
+#endif
+#ifdef RTOS_ENABLE_TIMING_STATS
+	job_complete ( CURRENT_TASK );
+#endif
+	task_list.tasks [ CURRENT_TASK ].state = S_SUSPENDED;
+	dispatcher ();
 }
 
 void rtos_activate_task ( rtos_task_handle_t task )
 {
-	task_list.tasks [ task ].state = S_READY;
-	dispatcher ( kFromNormalExec );
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+	if (caller_unprivileged ())
+	{
+		SYSCALL( SVC_ACTIVATE_TASK, task, 0 );
+		return;
+	}
+#endif
+#ifdef RTOS_ENABLE_BASIC_TASKS
+	if (task & RTOS_BASIC_TASK_FLAG)
+	{
+		rtos_kernel_basic_activate ( task );
+		dispatcher ();
+		return;
+	}
+#endif
+	task = task_index ( task );
+	if (INVALID_TASK != task)
+	{
+		make_ready ( task );
+		dispatcher ();
+	}
 }
 
-/**********************************************************************************/
-// Local methods implementation
-/**********************************************************************************/
+uint8_t rtos_delete_task ( rtos_task_handle_t task )
+{
+	rtos_critical_t critical;
+	rtos_task_handle_t index;
+	rtos_tcb_t *tcb;
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+	if (caller_unprivileged ())
+	{
+		SYSCALL( SVC_DELETE_TASK, task, 0 );
+		return 0;
+	}
+#endif
+	critical = rtos_kernel_enter_critical ();
+	index = task_index ( task );
+	if (INVALID_TASK == index)
+	{
+		rtos_kernel_exit_critical ( critical );
+		return 0;
+	}
+	tcb = &task_list.tasks [ index ];
+	tcb->state = S_DELETED;
+	tcb->generation = ( tcb->generation + 1 ) & HANDLE_GENERATION_MASK;
+	tcb->wait_object = 0;
+#ifdef RTOS_ENABLE_TIMING_STATS
+	tcb->deadline_ticks = 0;
+	tcb->deadline = 0;
+#endif
+#ifdef RTOS_ENABLE_CPU_BUDGET
+	tcb->budget_ticks = 0;
+	tcb->budget = 0;
+	tcb->throttled = 0;
+#endif
+#if RTOS_NUMBER_OF_CORES > 1
+	rtos_smp_remove_task ( index );
+#endif
+	//a running task still is on its stack, its slot is released once switched out
+	if (!task_running ( index ))
+	{
+		release_slot ( index );
+	}
+	//dispatched before leaving the critical section, the PendSV must not run a stale choice
+	dispatcher ();
+	rtos_kernel_exit_critical ( critical );
+	return 1;
+}
 
-static void reload_systick ( void )
+rtos_task_handle_t rtos_get_task_handle ( void )
 {
-	SysTick->LOAD = USEC_TO_COUNT( RTOS_TIC_PERIOD_IN_US,
-			CLOCK_GetCoreSysClkFreq () );
-	SysTick->VAL = 0;
+	rtos_task_handle_t current = CURRENT_TASK;
+	//before the scheduler starts there is no task running
+	return INVALID_TASK != current ? task_handle ( current ) : INVALID_TASK;
 }
 
-//Dispatcher is the scheuler's main function, as it assigns the tasks order to execute.
-static void dispatcher ( task_switch_type_e type )
+#if RTOS_NUMBER_OF_CORES > 1
+void rtos_start_secondary_core ( void )
 {
-	rtos_task_handle_t next_task = INVALID_TASK;
-	int8_t highest = -1;
-	for ( uint8_t index = 0; index < task_list.nTasks; index++ )
+	init_core ();
+	dispatcher ();
+	for ( ;; )
+		;
+}
+
+void rtos_set_task_affinity ( rtos_task_handle_t task,
+		rtos_affinity_t affinity )
+{
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	task = task_index ( task );
+	if (INVALID_TASK != task)
 	{
-		if (highest < task_list.tasks [ index ].priority
-				&& ( task_list.tasks [ index ].state == S_READY
-						|| task_list.tasks [ index ].state == S_RUNNING ))
-		{
-			next_task = index;
-			highest = task_list.tasks [ index ].priority;
-		}
+		rtos_smp_set_affinity ( task, affinity );
 	}
-	if (next_task != task_list.current_task)
+	rtos_kernel_exit_critical ( critical );
+}
+
+void rtos_handle_ipi ( void )
+{
+	dispatcher ();
+}
+#endif
+
+#ifdef RTOS_ENABLE_CPU_BUDGET
+void rtos_set_task_budget ( rtos_task_handle_t task, rtos_tick_t budget,
+		rtos_tick_t period, rtos_budget_action_e action )
+{
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	rtos_tcb_t *tcb;
+	task = task_index ( task );
+	if (INVALID_TASK == task)
 	{
-		task_list.next_task = next_task;
-		context_switch ( type );
+		rtos_kernel_exit_critical ( critical );
+		return;
 	}
+	tcb = &task_list.tasks [ task ];
+	if (tcb->throttled)
+	{
+		//the new budget starts fresh, a throttled task is given back
+		tcb->budget_replenish = task_list.global_tick;
+		enforce_budgets ();
+	}
+	tcb->budget_ticks = budget;
+	tcb->budget_used = 0;
+	tcb->budget_period = period;
+	tcb->budget_replenish = task_list.global_tick + period;
+	tcb->budget_action = action;
+	//before the scheduler starts the SysTick is not set, rtos_update_systick scales it
+	if (task_list.started)
+	{
+		scale_to_counts ( tcb );
+	}
+	rtos_kernel_exit_critical ( critical );
+	dispatcher ();
 }
+#endif
 
-//Context switch allows the microkernel to reload the previous state through the stack pointer handling and
-//the PendSV interrupt to reload the stack pointer value to the one we want.
-FORCE_INLINE static void context_switch ( task_switch_type_e type )
+#ifdef RTOS_ENABLE_SPORADIC_SERVER
+rtos_task_handle_t rtos_create_sporadic_server ( void (*task_body) ( ),
+		uint8_t priority, rtos_tick_t capacity, rtos_tick_t period,
+		rtos_autostart_e autostart )
 {
-	register uint32_t* sp asm("sp");
-	static uint8_t first_run = 1;
-	if (!first_run)
+	rtos_task_handle_t task = rtos_create_task ( task_body, priority,
+			autostart );
+	if (INVALID_TASK != task)
 	{
-		if (kFromNormalExec == type)
-		{
-			task_list.tasks [ task_list.current_task ].sp = sp - 9;
-		}
-		else
-		{
-			task_list.tasks [ task_list.current_task ].sp = sp + 9;
-		}
+		rtos_tcb_t *tcb = &task_list.tasks [ task_index ( task ) ];
+		tcb->sporadic = 1;
+		tcb->sporadic_active = 0;
+		tcb->nReplenishments = 0;
+		rtos_set_task_budget ( task, capacity, period, kBudgetDemote );
 	}
-	first_run = 0;
-	task_list.current_task = task_list.next_task;
-	task_list.tasks [ task_list.current_task ].state = S_RUNNING;
-	SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
+	return task;
 }
+#endif
 
-//This function allows the microkernel to wake up instructions basedon the global tick count from the OS
-static void activate_waiting_tasks ( )
+#ifdef RTOS_ENABLE_TIMING_STATS
+void rtos_set_task_deadline ( rtos_task_handle_t task, rtos_tick_t deadline )
 {
-	for ( uint8_t task_to_check = 0; task_to_check <= task_list.nTasks;
-			task_to_check++ )
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	rtos_tcb_t *tcb;
+	task = task_index ( task );
+	if (INVALID_TASK == task)
 	{
-		if (task_list.tasks [ task_to_check ].state == S_WAITING)
-		{
-			task_list.tasks [ task_to_check ].local_tick--;
-			if (!task_list.tasks [ task_to_check ].local_tick)
-			{
-				task_list.tasks [ task_to_check ].state = S_READY;
-			}
-		}
+		rtos_kernel_exit_critical ( critical );
+		return;
+	}
+	tcb = &task_list.tasks [ task ];
+	tcb->deadline_ticks = deadline;
+	tcb->deadline = 0;
+	//before the scheduler starts the SysTick is not set, rtos_update_systick scales it
+	if (task_list.started)
+	{
+		scale_to_counts ( tcb );
 	}
+	tcb->job_state = JOB_IDLE;
+	tcb->timing = ( rtos_task_timing_t )
+	{ 0 };
+	tcb->response_sum = 0;
+	tcb->min_start_latency = UINT32_MAX;
+	tcb->max_start_latency = 0;
+	rtos_kernel_exit_critical ( critical );
 }
 
-/**********************************************************************************/
-// IDLE TASK
-/**********************************************************************************/
-
-static void idle_task ( void )
+void rtos_get_task_timing ( rtos_task_handle_t task,
+		rtos_task_timing_t *timing )
 {
-	for ( ;; )
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	rtos_tcb_t *tcb;
+	task = task_index ( task );
+	if (INVALID_TASK == task)
+	{
+		rtos_kernel_exit_critical ( critical );
+		*timing = ( rtos_task_timing_t )
+		{ 0 };
+		return;
+	}
+	tcb = &task_list.tasks [ task ];
+	*timing = tcb->timing;
+	if (timing->jobs)
 	{
+		timing->mean_response = tcb->response_sum / timing->jobs;
+	}
+	rtos_kernel_exit_critical ( critical );
+}
+#endif
 
+void rtos_update_systick ( void )
+{
+	uint32_t counts = USEC_TO_COUNT( RTOS_TIC_PERIOD_IN_US,
+			CLOCK_GetCoreSysClkFreq () );
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	SysTick->LOAD = counts - 1;
+	task_list.ns_per_count = ( ( uint64_t ) RTOS_TIC_PERIOD_IN_US * 1000
+			<< 32 ) / counts;
+	for ( uint8_t index = 0; index < task_list.nTasks; index++ )
+	{
+		scale_to_counts ( &task_list.tasks [ index ] );
 	}
+	rtos_kernel_exit_critical ( critical );
 }
 
-/**********************************************************************************/
-// ISR implementation
-/**********************************************************************************/
-//SysTick handles the interrupts that the OS defines for itself to check if the tasks have completed
-//their times based on their local tick count, and the global tick.
-void SysTick_Handler ( void )
+uint32_t rtos_get_context_switches ( void )
 {
-#ifdef RTOS_ENABLE_IS_ALIVE
-	refresh_is_alive ();
+	return task_list.context_switches;
+}
+
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+void rtos_set_preemption_threshold ( rtos_task_handle_t task,
+		uint8_t threshold )
+{
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	task = task_index ( task );
+	if (INVALID_TASK == task)
+	{
+		rtos_kernel_exit_critical ( critical );
+		return;
+	}
+	task_list.tasks [ task ].preemption_threshold =
+			threshold > task_list.tasks [ task ].priority ?
+					threshold : task_list.tasks [ task ].priority;
+#if RTOS_NUMBER_OF_CORES > 1
+	rtos_smp_set_threshold ( task, task_list.tasks [ task ].preemption_threshold );
 #endif
-	task_list.global_tick++;
-	activate_waiting_tasks ();
-	dispatcher ( kFromISR );
-	reload_systick ();
+	rtos_kernel_exit_critical ( critical );
+	dispatcher ();
 }
+#endif
 
-//Lowest priority software-enabled interrupt which allows us to reload the proper context based on a trick
-//over the stack pointer to bring back the function that calls the context switch and the dispatcher.
-void PendSV_Handler ( void )
+uint32_t rtos_get_stack_high_water ( rtos_task_handle_t task )
 {
-	register uint32_t *r0 asm("r0");
-	SCB->ICSR |= SCB_ICSR_PENDSVCLR_Msk;
-	r0 = task_list.tasks [ task_list.current_task ].sp;
-	asm("mov r7, r0");
+	uint32_t untouched = 0;
+	task = task_index ( task );
+	if (INVALID_TASK == task)
+	{
+		return 0;
+	}
+	while (untouched < task_list.tasks [ task ].stack_words
+			&& STACK_PAINT == task_list.tasks [ task ].stack [ untouched ])
+	{
+		untouched++;
+	}
+	return task_list.tasks [ task ].stack_words - untouched;
 }
 
 /**********************************************************************************/
-// IS ALIVE SIGNAL IMPLEMENTATION
+// Kernel services implementation
 /**********************************************************************************/
 
-#ifdef RTOS_ENABLE_IS_ALIVE
-static void init_is_alive ( void )
+uint8_t rtos_kernel_block ( void *object, rtos_tick_t timeout,
+		rtos_critical_t critical )
 {
-	gpio_pin_config_t gpio_config =
-	{ kGPIO_DigitalOutput, 1, };
-
-	port_pin_config_t port_config =
-	{ kPORT_PullDisable, kPORT_FastSlewRate, kPORT_PassiveFilterDisable,
-			kPORT_OpenDrainDisable, kPORT_LowDriveStrength, kPORT_MuxAsGpio,
-			kPORT_UnlockRegister, };
-	CLOCK_EnableClock ( alive_CLOCK( RTOS_IS_ALIVE_PORT ) );
-	PORT_SetPinConfig ( alive_PORT( RTOS_IS_ALIVE_PORT ), RTOS_IS_ALIVE_PIN,
-			&port_config );
-	GPIO_PinInit ( alive_GPIO( RTOS_IS_ALIVE_PORT ), RTOS_IS_ALIVE_PIN,
-			&gpio_config );
+	rtos_tcb_t *task = &task_list.tasks [ CURRENT_TASK ];
+	task->wait_object = object;
+	task->wait_result = 0;
+	task->local_tick = to_local_tick ( timeout );
+	task->state = S_BLOCKED;
+#ifdef RTOS_ENABLE_TIMING_STATS
+	//a task waiting for its next event ends its job, as in rtos_delay
+	job_complete ( CURRENT_TASK );
+#endif
+	//a wake arriving before the dispatcher runs just leaves the task ready
+	rtos_kernel_exit_critical ( critical );
+	dispatcher ();
+	return task->wait_result;
 }
 
-static void refresh_is_alive ( void )
+uint8_t rtos_kernel_wake ( void *object, uint8_t wake_all )
 {
-	static uint8_t state = 0;
-	static uint32_t count = 0;
-	SysTick->LOAD = USEC_TO_COUNT( RTOS_TIC_PERIOD_IN_US,
-			CLOCK_GetCoreSysClkFreq () );
-	SysTick->VAL = 0;
-	if (RTOS_IS_ALIVE_PERIOD_IN_US / RTOS_TIC_PERIOD_IN_US - 1 == count)
+	rtos_task_handle_t woken = INVALID_TASK;
+	uint8_t count = 0;
+	for ( uint8_t index = 0; index < task_list.nTasks; index++ )
 	{
-		GPIO_WritePinOutput ( alive_GPIO( RTOS_IS_ALIVE_PORT ),
-				RTOS_IS_ALIVE_PIN, state );
-		state = state == 0 ? 1 : 0;
-		count = 0;
+		if (task_list.tasks [ index ].state == S_BLOCKED
+				&& task_list.tasks [ index ].wait_object == object)
+		{
+			if (wake_all)
+			{
+				task_list.tasks [ index ].wait_object = 0;
+				task_list.tasks [ index ].wait_result = 1;
+				make_ready ( index );
+				count++;
+			}
+			else if (INVALID_TASK == woken
+					|| task_list.tasks [ woken ].priority
+							< task_list.tasks [ index ].priority)
+			{
+				woken = index;
+			}
+		}
 	}
-	else
+	if (INVALID_TASK != woken)
 	{
+		task_list.tasks [ woken ].wait_object = 0;
+		task_list.tasks [ woken ].wait_result = 1;
+		make_ready ( woken );
 		count++;
 	}
+	return count;
+}
+
+void rtos_kernel_yield ( void )
+{
+	dispatcher ();
+}
+
+rtos_task_handle_t rtos_kernel_current_task ( void )
+{
+	return CURRENT_TASK;
+}
+
+#if RTOS_NUMBER_OF_CORES > 1
+static volatile uint8_t kernel_lock_owner = NO_CORE;
+static uint8_t kernel_lock_depth;
+
+rtos_critical_t rtos_kernel_enter_critical ( void )
+{
+	rtos_critical_t critical = __get_PRIMASK ();
+	__disable_irq ();
+	if (rtos_port_core_id () != kernel_lock_owner)
+	{
+		rtos_port_spin_lock ( RTOS_SMP_KERNEL_LOCK );
+		kernel_lock_owner = rtos_port_core_id ();
+	}
+	kernel_lock_depth++;
+	return critical;
+}
+
+void rtos_kernel_exit_critical ( rtos_critical_t critical )
+{
+	if (!--kernel_lock_depth)
+	{
+		kernel_lock_owner = NO_CORE;
+		rtos_port_spin_unlock ( RTOS_SMP_KERNEL_LOCK );
+	}
+	__set_PRIMASK ( critical );
+}
+#endif
+
+#ifdef RTOS_ENABLE_HEAP
+void rtos_kernel_heap_account ( rtos_task_handle_t task, int32_t bytes )
+{
+	//a stale handle is a task deleted before freeing, its slot may be charged to another
+	task = task_index ( task );
+	if (INVALID_TASK != task)
+	{
+		task_list.tasks [ task ].heap_bytes += bytes;
+	}
+}
+
+uint32_t rtos_kernel_heap_usage ( rtos_task_handle_t task )
+{
+	task = task_index ( task );
+	return INVALID_TASK != task ? task_list.tasks [ task ].heap_bytes : 0;
+}
+#endif
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+//Handles carry the generation of their slot above the index, a fresh slot is generation 0,
+//so until a task is deleted every handle equals its index
+static inline rtos_task_handle_t task_handle ( rtos_task_handle_t index )
+{
+	return index
+			| ( ( rtos_task_handle_t ) task_list.tasks [ index ].generation
+					<< HANDLE_GENERATION_SHIFT );
+}
+
+//Index of the slot of a handle, INVALID_TASK if it is out of range or its task was deleted.
+//A handle with bits out of the index and the generation, as a basic task one, is no task.
+static rtos_task_handle_t task_index ( rtos_task_handle_t task )
+{
+	rtos_task_handle_t index = task & HANDLE_INDEX_MASK;
+	if (task < 0
+			|| ( task & ~( HANDLE_INDEX_MASK
+					| HANDLE_GENERATION_MASK << HANDLE_GENERATION_SHIFT ) )
+			|| index >= task_list.nTasks
+			|| S_DELETED == task_list.tasks [ index ].state
+			|| task_list.tasks [ index ].generation
+					!= ( task >> HANDLE_GENERATION_SHIFT ))
+	{
+		return INVALID_TASK;
+	}
+	return index;
+}
+
+//Takes the last released slot, else a slot never used. The slot is left deleted, no handle
+//reaches it until its task is set up. Called inside a critical section.
+//A task on a stack of the caller, or on a kernel stack when there is none
+static rtos_task_handle_t create_task ( void (*task_body) ( ), uint8_t priority,
+		rtos_autostart_e autostart, uint32_t *stack, uint32_t words )
+{
+	rtos_task_handle_t retval = INVALID_TASK;
+	int8_t kernel_stack = INVALID_TASK;
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	rtos_task_handle_t index = allocate_slot ();
+	if (INVALID_TASK != index && !stack)
+	{
+		kernel_stack = allocate_stack ();
+		if (INVALID_TASK == kernel_stack)
+		{
+			release_slot ( index );
+			index = INVALID_TASK;
+		}
+		else
+		{
+			stack = kernel_stacks [ kernel_stack ].stack;
+		}
+	}
+	rtos_kernel_exit_critical ( critical );
+	if (INVALID_TASK != index)
+	{
+		task_list.tasks [ index ].stack = stack;
+		task_list.tasks [ index ].stack_words = words;
+		task_list.tasks [ index ].kernel_stack = kernel_stack;
+		for ( uint32_t word = 0; word < words; word++ )
+		{
+			stack [ word ] = STACK_PAINT;
+		}
+		for ( uint8_t word = 0; word < RTOS_STACK_GUARD_WORDS; word++ )
+		{
+			( stack - RTOS_STACK_GUARD_WORDS ) [ word ] = STACK_PAINT;
+		}
+		task_list.tasks [ index ].priority = priority;
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+		task_list.tasks [ index ].preemption_threshold = priority;
+		task_list.tasks [ index ].preempted = 0;
+#endif
+		task_list.tasks [ index ].local_tick = 0;
+		task_list.tasks [ index ].wait_object = 0;
+#ifdef RTOS_ENABLE_HEAP
+		task_list.tasks [ index ].heap_bytes = 0;
+#endif
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+		task_list.tasks [ index ].unprivileged = 0;
+#endif
+#ifdef RTOS_ENABLE_TIMING_STATS
+		task_list.tasks [ index ].deadline_ticks = 0;
+		task_list.tasks [ index ].deadline = 0;
+#endif
+#ifdef RTOS_ENABLE_CPU_BUDGET
+		task_list.tasks [ index ].budget_ticks = 0;
+		task_list.tasks [ index ].budget = 0;
+		task_list.tasks [ index ].throttled = 0;
+#ifdef RTOS_ENABLE_SPORADIC_SERVER
+		task_list.tasks [ index ].sporadic = 0;
+#endif
+#endif
+		task_list.tasks [ index ].task_body = task_body;
+		task_list.tasks [ index ].sp = &stack [ words - STACK_FRAME_SIZE
+				- STACK_SW_FRAME_SIZE ];	//stack is used bottoms up
+		task_list.tasks [ index ].state = S_SUSPENDED;
+		stack [ words - STACK_LR_OFFSET ] = ( uint32_t ) task_exit;	//a body that returns is deleted
+		stack [ words - STACK_PC_OFFSET ] = ( uint32_t ) task_body;
+		stack [ words - STACK_PSR_OFFSET ] = STACK_PSR_DEFAULT;
+		stack [ words - STACK_EXC_RETURN_OFFSET ] = EXC_RETURN_THREAD_PSP;
+		retval = task_handle ( index );
+#if RTOS_NUMBER_OF_CORES > 1
+		rtos_smp_add_task ( index, priority );
+#endif
+		if (kAutoStart == autostart)
+		{
+			make_ready ( index );
+		}
+
+	}
+	return retval;
+}
+
+static rtos_task_handle_t allocate_slot ( void )
+{
+	rtos_task_handle_t index = task_list.free_slot;
+	if (INVALID_TASK != index)
+	{
+		task_list.free_slot = task_list.tasks [ index ].next_free;
+	}
+	else if (RTOS_MAX_NUMBER_OF_TASKS > task_list.nTasks)
+	{
+		index = task_list.nTasks;
+		task_list.tasks [ index ].state = S_DELETED;
+		task_list.tasks [ index ].kernel_stack = INVALID_TASK;
+		task_list.nTasks++;
+	}
+	return index;
+}
+
+//Called inside a critical section, the kernel stack of the task goes back with the slot
+static void release_slot ( rtos_task_handle_t index )
+{
+	if (INVALID_TASK != task_list.tasks [ index ].kernel_stack)
+	{
+		task_list.stack_used [ task_list.tasks [ index ].kernel_stack ] = 0;
+		task_list.tasks [ index ].kernel_stack = INVALID_TASK;
+	}
+	task_list.tasks [ index ].next_free = task_list.free_slot;
+	task_list.free_slot = index;
+}
+
+//Called inside a critical section
+static int8_t allocate_stack ( void )
+{
+	for ( int8_t stack = 0; stack < RTOS_KERNEL_STACKS; stack++ )
+	{
+		if (!task_list.stack_used [ stack ])
+		{
+			task_list.stack_used [ stack ] = 1;
+			return stack;
+		}
+	}
+	return INVALID_TASK;
+}
+
+static uint8_t task_running ( rtos_task_handle_t index )
+{
+#if RTOS_NUMBER_OF_CORES > 1
+	for ( uint8_t core = 0; core < RTOS_NUMBER_OF_CORES; core++ )
+	{
+		if (task_list.current_task [ core ] == index)
+		{
+			return 1;
+		}
+	}
+	return 0;
+#else
+	return task_list.current_task == index;
+#endif
+}
+
+//Return address of the task bodies
+static void task_exit ( void )
+{
+	rtos_delete_task ( rtos_get_task_handle () );
+	for ( ;; )
+		;
+}
+
+//Increments the global tick and publishes it on the latch: the sequence is odd while the
+//first copy is written and even while the second one is, so a reader always finds the
+//other copy whole, even when it interrupts this, and never has to wait for the writer.
+static void advance_tick ( void )
+{
+	rtos_tick_t tick = task_list.global_tick + 1;
+	task_list.global_tick = tick;
+	task_list.tick_sequence++;
+	__DMB ();
+	task_list.tick_copies [ 0 ] = tick;
+	__DMB ();
+	task_list.tick_sequence++;
+	__DMB ();
+	task_list.tick_copies [ 1 ] = tick;
+}
+
+//Waits count down in 32 bits, the longer ones are cut just below LOCAL_TICK_FOREVER
+static inline uint32_t to_local_tick ( rtos_tick_t ticks )
+{
+	if (RTOS_WAIT_FOREVER == ticks)
+	{
+		return LOCAL_TICK_FOREVER;
+	}
+	return ticks < LOCAL_TICK_FOREVER ? ( uint32_t ) ticks : LOCAL_TICK_FOREVER - 1;
+}
+
+//Reads the global tick and the counts of the SysTick elapsed in it, without masking the
+//interrupts: the read is retried if a tick got in between. A wrap whose ISR is pending,
+//because the caller masked it or outranks it, is seen as a counter reloaded near LOAD.
+static void read_timebase ( rtos_tick_t *tick, uint32_t *counts )
+{
+	uint32_t load = SysTick->LOAD;
+	uint32_t sequence;
+	uint32_t value;
+	uint32_t pending;
+	do
+	{
+		sequence = task_list.tick_sequence;
+		__DMB ();
+		*tick = task_list.tick_copies [ sequence & 1 ];
+		value = SysTick->VAL;
+		pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+		__DMB ();
+	} while (sequence != task_list.tick_sequence);
+	if (pending && value > load / 2)
+	{
+		( *tick )++;
+	}
+	*counts = load - value;
+}
+
+//Sets the process stack and the exceptions of the core calling it, the context of main is
+//discarded and PendSV saves it on a scratch area
+static void init_core ( void )
+{
+	static uint32_t core_context [ RTOS_NUMBER_OF_CORES ] [ CORE_CONTEXT_SIZE ];
+#if RTOS_NUMBER_OF_CORES > 1
+	__set_PSP ( ( uint32_t ) &core_context [ rtos_port_core_id () ] [ CORE_CONTEXT_SIZE ] );
+#else
+	__set_PSP ( ( uint32_t ) &core_context [ 0 ] [ CORE_CONTEXT_SIZE ] );
+#endif
+#ifdef RTOS_ENABLE_MPU_STACK_GUARD
+	init_mpu ();
+#endif
+	NVIC_SetPriority ( PendSV_IRQn, ( 1 << __NVIC_PRIO_BITS ) - 1 );
+#if defined(__FPU_USED) && __FPU_USED
+	//the core stacks s0-s15 only when the ISR uses the FPU, and only for tasks that used it
+	FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+#endif
+#ifdef RTOS_ENABLE_TIMING_STATS
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+//Every task becoming ready goes through here, in SMP mode it is also queued on a core
+static void make_ready ( rtos_task_handle_t task )
+{
+#ifdef RTOS_ENABLE_TIMING_STATS
+	job_release ( task );
+#endif
+#ifdef RTOS_ENABLE_CPU_BUDGET
+	//a task suspended by its budget waits for its next period
+	if (task_list.tasks [ task ].throttled
+			&& kBudgetSuspend == task_list.tasks [ task ].budget_action)
+	{
+		return;
+	}
+#endif
+#if RTOS_NUMBER_OF_CORES > 1
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	task_list.tasks [ task ].state = S_READY;
+	rtos_smp_ready ( task );
+	rtos_kernel_exit_critical ( critical );
+#else
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+	//a preempted task suspended since then by its budget gets ready at its priority
+	if (S_READY != task_list.tasks [ task ].state
+			&& S_RUNNING != task_list.tasks [ task ].state)
+	{
+		task_list.tasks [ task ].preempted = 0;
+	}
+#endif
+	task_list.tasks [ task ].state = S_READY;
+#endif
+}
+
+#if RTOS_NUMBER_OF_CORES > 1
+//In SMP mode each core dispatches itself: it only compares its running task with its own
+//ready queue, the choice and the queue updates are made by the PendSV.
+static void dispatcher ( void )
+{
+	uint8_t core = rtos_port_core_id ();
+	rtos_critical_t critical;
+	rtos_task_handle_t current;
+	//before init_core the PendSV has neither its priority nor a process stack to save on
+	if (!task_list.started)
+	{
+		return;
+	}
+	critical = rtos_kernel_enter_critical ();
+	current = task_list.current_task [ core ];
+	if (rtos_smp_should_switch ( core, current,
+			INVALID_TASK != current
+					&& ( task_list.tasks [ current ].state == S_READY
+							|| task_list.tasks [ current ].state == S_RUNNING ) ))
+	{
+		SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
+	}
+	rtos_kernel_exit_critical ( critical );
+}
+
+static uint32_t *context_switch ( uint32_t *sp )
+{
+	uint8_t core = rtos_port_core_id ();
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	rtos_task_handle_t current = task_list.current_task [ core ];
+	rtos_task_handle_t next;
+	uint8_t runnable = 0;
+	if (INVALID_TASK != current)
+	{
+		task_list.tasks [ current ].sp = sp;
+#ifdef RTOS_ENABLE_STACK_CHECK
+		check_stack ( current );
+#endif
+		runnable = task_list.tasks [ current ].state == S_READY
+				|| task_list.tasks [ current ].state == S_RUNNING;
+	}
+	next = rtos_smp_pick ( core, current, runnable );
+	if (INVALID_TASK != current && next != current
+			&& S_DELETED == task_list.tasks [ current ].state)
+	{
+		release_slot ( current );
+	}
+	if (next != current)
+	{
+		task_list.context_switches++;
+	}
+	if (runnable && next != current)
+	{
+		task_list.tasks [ current ].state = S_READY;
+	}
+	task_list.current_task [ core ] = next;
+	task_list.tasks [ next ].state = S_RUNNING;
+#ifdef RTOS_ENABLE_TIMING_STATS
+	job_start ( next );
+#endif
+#ifdef RTOS_ENABLE_MPU_STACK_GUARD
+	set_mpu_regions ( next );
+#endif
+	rtos_kernel_exit_critical ( critical );
+	return task_list.tasks [ next ].sp;
+}
+#else
+//Dispatcher is the scheuler's main function, as it assigns the tasks order to execute.
+//The switch itself is left to the PendSV, which runs once no other ISR is active.
+static void dispatcher ( void )
+{
+	rtos_task_handle_t next_task = INVALID_TASK;
+	int8_t highest = -1;
+	rtos_critical_t critical;
+	//before init_core the PendSV has neither its priority nor a process stack to save on
+	if (!task_list.started)
+	{
+		return;
+	}
+	critical = rtos_kernel_enter_critical ();
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+	//a task still runnable keeps the core against the tasks up to its threshold
+	if (INVALID_TASK != task_list.current_task
+			&& task_list.idle != task_list.current_task
+			&& ( task_list.tasks [ task_list.current_task ].state == S_READY
+					|| task_list.tasks [ task_list.current_task ].state
+							== S_RUNNING ))
+	{
+		next_task = task_list.current_task;
+		highest =
+				task_list.tasks [ task_list.current_task ].preemption_threshold;
+	}
+#endif
+	for ( uint8_t index = 0; index < task_list.nTasks; index++ )
+	{
+		uint8_t priority = task_list.tasks [ index ].priority;
+		if (task_list.idle == index)
+		{
+			//below every priority, even the background one of the demoted tasks
+			continue;
+		}
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+		//a preempted task competes at its threshold until it runs again, so the tasks it
+		//kept out while running do not take the core ahead of it
+		if (task_list.tasks [ index ].preempted)
+		{
+			priority = task_list.tasks [ index ].preemption_threshold;
+		}
+#endif
+		if (highest < priority
+				&& ( task_list.tasks [ index ].state == S_READY
+						|| task_list.tasks [ index ].state == S_RUNNING ))
+		{
+			next_task = index;
+			highest = priority;
+		}
+	}
+	if (INVALID_TASK == next_task)
+	{
+		next_task = task_list.idle;
+	}
+	task_list.next_task = next_task;
+	if (next_task != task_list.current_task)
+	{
+		SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
+	}
+	rtos_kernel_exit_critical ( critical );
+}
+
+//Context switch is called by the PendSV with the stack pointer of the task leaving, once its
+//registers are stacked, and returns the stack pointer of the task to resume.
+static uint32_t *context_switch ( uint32_t *sp )
+{
+	//the slot of a deleted task goes back to the free list, shared with the task API
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	rtos_task_handle_t current = task_list.current_task;
+	rtos_task_handle_t next = task_list.next_task;
+#ifdef RTOS_ENABLE_CPU_BUDGET
+	charge_budget ( SysTick->LOAD - SysTick->VAL );
+#endif
+	if (INVALID_TASK != current)
+	{
+		task_list.tasks [ current ].sp = sp;
+#ifdef RTOS_ENABLE_STACK_CHECK
+		check_stack ( current );
+#endif
+		if (S_DELETED == task_list.tasks [ current ].state)
+		{
+			release_slot ( current );
+		}
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+		else if (next != current
+				&& ( task_list.tasks [ current ].state == S_READY
+						|| task_list.tasks [ current ].state == S_RUNNING ))
+		{
+			task_list.tasks [ current ].preempted = 1;
+		}
+#endif
+	}
+	if (next != current)
+	{
+		task_list.context_switches++;
+	}
+	task_list.current_task = next;
+	task_list.tasks [ next ].state = S_RUNNING;
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+	task_list.tasks [ next ].preempted = 0;
+#endif
+#ifdef RTOS_ENABLE_TIMING_STATS
+	job_start ( next );
+#endif
+#ifdef RTOS_ENABLE_MPU_STACK_GUARD
+	set_mpu_regions ( next );
+#endif
+	rtos_kernel_exit_critical ( critical );
+	return task_list.tasks [ next ].sp;
+}
+#endif
+
+//The budgets and deadlines are set in ticks, they are measured in SysTick counts of the
+//current reload
+static void scale_to_counts ( rtos_tcb_t *tcb )
+{
+#ifdef RTOS_ENABLE_CPU_BUDGET
+	rtos_tick_t budget = tcb->budget_ticks * ( SysTick->LOAD + 1 );
+	tcb->budget = budget > UINT32_MAX ? UINT32_MAX : budget;
+#endif
+#ifdef RTOS_ENABLE_TIMING_STATS
+	rtos_tick_t deadline = tcb->deadline_ticks * ( SysTick->LOAD + 1 );
+	tcb->deadline = deadline > UINT32_MAX ? UINT32_MAX : deadline;
+#endif
+}
+
+#ifdef RTOS_ENABLE_STACK_CHECK
+//A task overflowed if its stack pointer left the stack or the guard below it got written
+static void check_stack ( rtos_task_handle_t task )
+{
+	uint8_t overflow = task_list.tasks [ task ].sp
+			< task_list.tasks [ task ].stack;
+	for ( uint8_t index = 0; index < RTOS_STACK_GUARD_WORDS; index++ )
+	{
+		if (STACK_PAINT != ( task_list.tasks [ task ].stack
+				- RTOS_STACK_GUARD_WORDS ) [ index ])
+		{
+			overflow = 1;
+		}
+	}
+	if (overflow)
+	{
+		rtos_stack_overflow_hook ( task_handle ( task ) );
+	}
+}
+#endif
+
+#ifdef RTOS_ENABLE_TIMING_STATS
+//A job is released when a task idle since its last completion gets ready
+static void job_release ( rtos_task_handle_t task )
+{
+	rtos_tcb_t *tcb = &task_list.tasks [ task ];
+	if (tcb->deadline && JOB_IDLE == tcb->job_state)
+	{
+		tcb->job_state = JOB_RELEASED;
+		tcb->timing.release_cycles = DWT->CYCCNT;
+		tcb->timing.release = rtos_get_clock ();
+		tcb->timing.deadline = tcb->timing.release + tcb->deadline_ticks;
+	}
+}
+
+//The start latency varies with the load above the task, its spread is the start jitter
+static void job_start ( rtos_task_handle_t task )
+{
+	rtos_tcb_t *tcb = &task_list.tasks [ task ];
+	if (JOB_RELEASED == tcb->job_state)
+	{
+		uint32_t latency;
+		tcb->job_state = JOB_STARTED;
+		tcb->timing.start_cycles = DWT->CYCCNT;
+		latency = tcb->timing.start_cycles - tcb->timing.release_cycles;
+		if (latency < tcb->min_start_latency)
+		{
+			tcb->min_start_latency = latency;
+		}
+		if (latency > tcb->max_start_latency)
+		{
+			tcb->max_start_latency = latency;
+		}
+		tcb->timing.max_start_jitter = tcb->max_start_latency
+				- tcb->min_start_latency;
+	}
+}
+
+static void job_complete ( rtos_task_handle_t task )
+{
+	rtos_tcb_t *tcb = &task_list.tasks [ task ];
+	if (JOB_STARTED == tcb->job_state)
+	{
+		uint32_t response;
+		tcb->job_state = JOB_IDLE;
+		tcb->timing.completion_cycles = DWT->CYCCNT;
+		response = tcb->timing.completion_cycles - tcb->timing.release_cycles;
+		if (response > tcb->timing.max_response)
+		{
+			tcb->timing.max_response = response;
+		}
+		if (response > tcb->deadline)
+		{
+			tcb->timing.deadline_misses++;
+		}
+		tcb->response_sum += response;
+		tcb->timing.jobs++;
+	}
+}
+#endif
+
+#ifdef RTOS_ENABLE_CPU_BUDGET
+//The counts of the current tick elapsed since the last accounting go to the running task,
+//unless it is throttled. A count behind the last one means the tick wrapped, the SysTick
+//charges the rest.
+static void charge_budget ( uint32_t now )
+{
+	rtos_task_handle_t task = task_list.current_task;
+	if (INVALID_TASK != task && task_list.tasks [ task ].budget
+			&& !task_list.tasks [ task ].throttled
+			&& now > task_list.slice_start)
+	{
+		task_list.tasks [ task ].budget_used += now - task_list.slice_start;
+	}
+	task_list.slice_start = now;
+}
+
+//Gives the budgets back at the end of their periods and throttles the tasks that overran.
+//Only a ready or running task is throttled, a waiting one is checked again next tick.
+static void enforce_budgets ( void )
+{
+	for ( uint8_t index = 0; index < task_list.nTasks; index++ )
+	{
+		rtos_tcb_t *task = &task_list.tasks [ index ];
+		if (!task->budget)
+		{
+			continue;
+		}
+#ifdef RTOS_ENABLE_SPORADIC_SERVER
+		if (task->sporadic)
+		{
+			sporadic_budget ( index );
+			continue;
+		}
+#endif
+		if (task_list.global_tick >= task->budget_replenish)
+		{
+			task->budget_used = 0;
+			task->budget_replenish += task->budget_period;
+			if (task->budget_replenish <= task_list.global_tick)
+			{
+				task->budget_replenish = task_list.global_tick
+						+ task->budget_period;
+			}
+			if (task->throttled)
+			{
+				task->throttled = 0;
+				if (kBudgetDemote == task->budget_action)
+				{
+					task->priority = task->base_priority;
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+					task->preemption_threshold = task->base_threshold;
+#endif
+				}
+				else
+				{
+					make_ready ( index );
+				}
+			}
+		}
+		else if (!task->throttled && task->budget_used > task->budget
+				&& ( S_READY == task->state || S_RUNNING == task->state ))
+		{
+			task->throttled = 1;
+			if (kBudgetDemote == task->budget_action)
+			{
+				task->base_priority = task->priority;
+				task->priority = BACKGROUND_PRIORITY;
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+				task->base_threshold = task->preemption_threshold;
+				task->preemption_threshold = BACKGROUND_PRIORITY;
+#endif
+			}
+			else
+			{
+				task->state = S_SUSPENDED;
+			}
+			rtos_budget_overrun_hook ( task_handle ( index ) );
+		}
+	}
+}
+
+#ifdef RTOS_ENABLE_SPORADIC_SERVER
+//A busy interval runs while the server is ready at its priority. What it consumed in the
+//interval is given back one period after the interval started; with the replenishment list
+//full it is added to the last one, which only delays it. The interval edges are seen at the
+//ticks, a late start only delays the replenishment too.
+static void sporadic_budget ( rtos_task_handle_t index )
+{
+	rtos_tcb_t *task = &task_list.tasks [ index ];
+	uint8_t runnable = S_READY == task->state || S_RUNNING == task->state;
+	while (task->nReplenishments
+			&& task->replenishments [ 0 ].tick <= task_list.global_tick)
+	{
+		uint32_t amount = task->replenishments [ 0 ].amount;
+		task->budget_used =
+				amount < task->budget_used ? task->budget_used - amount : 0;
+		task->sporadic_used =
+				amount < task->sporadic_used ? task->sporadic_used - amount : 0;
+		task->nReplenishments--;
+		for ( uint8_t entry = 0; entry < task->nReplenishments; entry++ )
+		{
+			task->replenishments [ entry ] = task->replenishments [ entry + 1 ];
+		}
+	}
+	if (task->sporadic_active
+			&& ( !runnable || task->budget_used >= task->budget ))
+	{
+		uint8_t entry = task->nReplenishments;
+		if (RTOS_SPORADIC_REPLENISHMENTS == entry)
+		{
+			entry--;
+			task->replenishments [ entry ].amount += task->budget_used
+					- task->sporadic_used;
+		}
+		else
+		{
+			task->replenishments [ entry ].amount = task->budget_used
+					- task->sporadic_used;
+			task->nReplenishments++;
+		}
+		task->replenishments [ entry ].tick = task->sporadic_start
+				+ task->budget_period;
+		task->sporadic_active = 0;
+	}
+	if (task->throttled && task->budget_used < task->budget)
+	{
+		task->throttled = 0;
+		task->priority = task->base_priority;
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+		task->preemption_threshold = task->base_threshold;
+#endif
+	}
+	else if (!task->throttled && task->budget_used >= task->budget)
+	{
+		task->throttled = 1;
+		task->base_priority = task->priority;
+		task->priority = BACKGROUND_PRIORITY;
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+		task->base_threshold = task->preemption_threshold;
+		task->preemption_threshold = BACKGROUND_PRIORITY;
+#endif
+		rtos_budget_overrun_hook ( task_handle ( index ) );
+	}
+	if (!task->sporadic_active && runnable && !task->throttled)
+	{
+		task->sporadic_active = 1;
+		task->sporadic_start = task_list.global_tick;
+		task->sporadic_used = task->budget_used;
+	}
+}
+#endif
+
+__attribute__((weak)) void rtos_budget_overrun_hook ( rtos_task_handle_t task )
+{
+}
+#endif
+
+#if defined(RTOS_ENABLE_STACK_CHECK) || defined(RTOS_ENABLE_MPU_STACK_GUARD)
+__attribute__((weak)) void rtos_stack_overflow_hook ( rtos_task_handle_t task )
+{
+	for ( ;; )
+	{
+
+	}
+}
+#endif
+
+/**********************************************************************************/
+// MPU implementation
+/**********************************************************************************/
+
+#ifdef RTOS_ENABLE_MPU_STACK_GUARD
+static void init_mpu ( void )
+{
+	ARM_MPU_Disable ();
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+	//the first GB holds the flash and the RAM, the peripherals are left out
+	MPU->RBAR = ARM_MPU_RBAR( MPU_BACKGROUND_REGION, 0 );
+	MPU->RASR = ARM_MPU_RASR( 0, ARM_MPU_AP_URO, 0, 0, 1, 0, 0,
+			ARM_MPU_REGION_SIZE_1GB );
+#endif
+	SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk;
+	ARM_MPU_Enable ( MPU_CTRL_PRIVDEFENA_Msk );
+}
+
+//Called on every switch with the task to resume, a stack push into the band
+//below its stack faults at once, with no software check
+static void set_mpu_regions ( rtos_task_handle_t task )
+{
+	MPU->RBAR = ARM_MPU_RBAR( MPU_GUARD_REGION,
+			( uint32_t ) task_list.tasks [ task ].stack - MPU_GUARD_SIZE );
+	MPU->RASR = ARM_MPU_RASR( 1, ARM_MPU_AP_NONE, 0, 0, 1, 0, 0,
+			ARM_MPU_REGION_SIZE_32B );
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+	MPU->RBAR = ARM_MPU_RBAR( MPU_STACK_REGION,
+			( uint32_t ) task_list.tasks [ task ].stack );
+	MPU->RASR = ARM_MPU_RASR( 1, ARM_MPU_AP_FULL, 0, 0, 1, 0, 0,
+			__builtin_ctz ( task_list.tasks [ task ].stack_words * 4 ) - 1 );
+	if (task_list.tasks [ task ].unprivileged)
+	{
+		__set_CONTROL ( __get_CONTROL () | CONTROL_nPRIV_Msk );
+	}
+	else
+	{
+		__set_CONTROL ( __get_CONTROL () & ~CONTROL_nPRIV_Msk );
+	}
+#endif
+	__DSB ();
+	__ISB ();
+}
+
+__attribute__((weak)) void rtos_memory_fault_hook ( rtos_task_handle_t task )
+{
+	for ( ;; )
+	{
+
+	}
+}
+#endif
+
+//This function allows the microkernel to wake up instructions basedon the global tick count from the OS
+static void activate_waiting_tasks ( )
+{
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	for ( uint8_t task_to_check = 0; task_to_check <= task_list.nTasks;
+			task_to_check++ )
+	{
+		if (task_list.tasks [ task_to_check ].state == S_WAITING)
+		{
+			task_list.tasks [ task_to_check ].local_tick--;
+			if (!task_list.tasks [ task_to_check ].local_tick)
+			{
+				make_ready ( task_to_check );
+			}
+		}
+		else if (task_list.tasks [ task_to_check ].state == S_BLOCKED
+				&& LOCAL_TICK_FOREVER != task_list.tasks [ task_to_check ].local_tick)
+		{
+			task_list.tasks [ task_to_check ].local_tick--;
+			if (!task_list.tasks [ task_to_check ].local_tick)
+			{
+				task_list.tasks [ task_to_check ].wait_object = 0;
+				make_ready ( task_to_check );
+			}
+		}
+	}
+	rtos_kernel_exit_critical ( critical );
+}
+
+/**********************************************************************************/
+// IDLE TASK
+/**********************************************************************************/
+
+static void idle_task ( void )
+{
+	for ( ;; )
+	{
+
+	}
+}
+
+/**********************************************************************************/
+// ISR implementation
+/**********************************************************************************/
+//SysTick handles the interrupts that the OS defines for itself to check if the tasks have completed
+//their times based on their local tick count, and the global tick.
+void SysTick_Handler ( void )
+{
+#ifdef RTOS_ENABLE_IS_ALIVE
+	refresh_is_alive ();
+#endif
+	advance_tick ();
+#ifdef RTOS_ENABLE_CPU_BUDGET
+	charge_budget ( SysTick->LOAD + 1 );
+	task_list.slice_start = 0;
+	enforce_budgets ();
+#endif
+	activate_waiting_tasks ();
+#ifdef RTOS_ENABLE_SOFTWARE_TIMERS
+	rtos_timer_service_tick ();
+#endif
+	dispatcher ();
+}
+
+//Lowest priority software-enabled interrupt, it stacks the registers the core did not save on
+//the process stack of the task leaving and unstacks them from the one of the task to resume.
+//Tasks run on the PSP, so the ISRs never use their stacks. A task that used the FPU enters
+//with bit 4 of EXC_RETURN clear, only then s16-s31 are stacked too; touching them also makes
+//the core store the s0-s15 it lazily left pending. Integer only tasks keep the short switch.
+__attribute__((naked)) void PendSV_Handler ( void )
+{
+	asm volatile (
+			"mrs r0, psp\n"
+#if defined(__FPU_USED) && __FPU_USED
+			"tst lr, #0x10\n"
+			"it eq\n"
+			"vstmdbeq r0!, {s16-s31}\n"
+#endif
+			"stmdb r0!, {r4-r11, lr}\n"
+			"bl context_switch\n"
+			"ldmia r0!, {r4-r11, lr}\n"
+#if defined(__FPU_USED) && __FPU_USED
+			"tst lr, #0x10\n"
+			"it eq\n"
+			"vldmiaeq r0!, {s16-s31}\n"
+#endif
+			"msr psp, r0\n"
+			"bx lr\n"
+	);
+}
+
+#ifdef RTOS_ENABLE_MPU_STACK_GUARD
+//A fault while stacking, or on the guard band, is a stack overflow; anything else
+//is an access the task had no rights for
+void MemManage_Handler ( void )
+{
+	uint32_t guard = ( uint32_t ) task_list.tasks [ CURRENT_TASK ].stack
+			- MPU_GUARD_SIZE;
+	if (( SCB->CFSR & ( SCB_CFSR_MSTKERR_Msk | SCB_CFSR_MLSPERR_Msk ) )
+			|| ( ( SCB->CFSR & SCB_CFSR_MMARVALID_Msk ) && SCB->MMFAR >= guard
+					&& SCB->MMFAR < guard + MPU_GUARD_SIZE ))
+	{
+		rtos_stack_overflow_hook ( task_handle ( CURRENT_TASK ) );
+	}
+	else
+	{
+		rtos_memory_fault_hook ( task_handle ( CURRENT_TASK ) );
+	}
+}
+#endif
+
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+//Finds the stack the svc instruction was stacked on and hands it to the syscall gate
+__attribute__((naked)) void SVC_Handler ( void )
+{
+	asm volatile (
+			"tst lr, #4\n"
+			"ite eq\n"
+			"mrseq r0, msp\n"
+			"mrsne r0, psp\n"
+			"b syscall_gate\n"
+	);
+}
+
+//The syscall number is the immediate of the svc instruction, right before the stacked pc
+__attribute__((used)) static void syscall_gate ( uint32_t *frame )
+{
+	uint64_t result;
+	uint8_t number = ( ( uint8_t * ) frame [ STACK_FRAME_SIZE
+			- STACK_PC_OFFSET ] ) [ -2 ];
+	switch (number)
+	{
+		case SVC_SUSPEND_TASK:
+			rtos_suspend_task ();
+			break;
+		case SVC_ACTIVATE_TASK:
+			rtos_activate_task ( ( rtos_task_handle_t ) frame [ 0 ] );
+			break;
+		case SVC_DELAY:
+			rtos_delay ( frame [ 0 ] | ( ( rtos_tick_t ) frame [ 1 ] << 32 ) );
+			break;
+		case SVC_DELETE_TASK:
+			//an unprivileged task can only delete itself
+			if (task_index ( ( rtos_task_handle_t ) frame [ 0 ] ) == CURRENT_TASK)
+			{
+				rtos_delete_task ( ( rtos_task_handle_t ) frame [ 0 ] );
+			}
+			break;
+		case SVC_GET_CYCLES:
+			result = rtos_get_cycles ();
+			frame [ 0 ] = ( uint32_t ) result;
+			frame [ 1 ] = ( uint32_t ) ( result >> 32 );
+			break;
+		case SVC_GET_TIME_NS:
+			result = rtos_get_time_ns ();
+			frame [ 0 ] = ( uint32_t ) result;
+			frame [ 1 ] = ( uint32_t ) ( result >> 32 );
+			break;
+		default:
+			break;
+	}
+}
+#endif
+
+/**********************************************************************************/
+// IS ALIVE SIGNAL IMPLEMENTATION
+/**********************************************************************************/
+
+#ifdef RTOS_ENABLE_IS_ALIVE
+static void init_is_alive ( void )
+{
+	gpio_pin_config_t gpio_config =
+	{ kGPIO_DigitalOutput, 1, };
+
+	port_pin_config_t port_config =
+	{ kPORT_PullDisable, kPORT_FastSlewRate, kPORT_PassiveFilterDisable,
+			kPORT_OpenDrainDisable, kPORT_LowDriveStrength, kPORT_MuxAsGpio,
+			kPORT_UnlockRegister, };
+	CLOCK_EnableClock ( alive_CLOCK( RTOS_IS_ALIVE_PORT ) );
+	PORT_SetPinConfig ( alive_PORT( RTOS_IS_ALIVE_PORT ), RTOS_IS_ALIVE_PIN,
+			&port_config );
+	GPIO_PinInit ( alive_GPIO( RTOS_IS_ALIVE_PORT ), RTOS_IS_ALIVE_PIN,
+			&gpio_config );
+}
+
+static void refresh_is_alive ( void )
+{
+	static uint8_t state = 0;
+	static rtos_tick_t next_toggle = IS_ALIVE_PERIOD_IN_TICKS - 1;
+	if (task_list.global_tick >= next_toggle)
+	{
+		GPIO_WritePinOutput ( alive_GPIO( RTOS_IS_ALIVE_PORT ),
+				RTOS_IS_ALIVE_PIN, state );
+		state = state == 0 ? 1 : 0;
+		next_toggle += IS_ALIVE_PERIOD_IN_TICKS;
+	}
 }
 #endif
@@ -20,12 +20,52 @@ typedef enum
 	kAutoStart, kStartSuspended
 } rtos_autostart_e;
 
-/*! @brief Task handle type, used to identify a task */
-typedef int8_t rtos_task_handle_t;
+/*! @brief Task handle type, used to identify a task. It tags the TCB
+ * slot with a generation, so a handle of a deleted task is rejected */
+typedef int16_t rtos_task_handle_t;
 
 /*! @brief Tick type, used for time measurement */
 typedef uint64_t rtos_tick_t;
 
+/*! @brief Affinity type, bit n set allows a task on core n */
+typedef uint32_t rtos_affinity_t;
+
+/*! @brief Affinity allowing a task on every core */
+#define RTOS_AFFINITY_ALL	((rtos_affinity_t) -1)
+
+/*! @brief Timeout value to wait without time limit */
+#define RTOS_WAIT_FOREVER	((rtos_tick_t) -1)
+
+/*! @brief Words right below each stack kept painted, as its overflow guard */
+#define RTOS_STACK_GUARD_WORDS	10
+
+/*! @brief Smallest stack in words, the context of a task using the FPU */
+#define RTOS_STACK_MIN_WORDS	(17 + 34)
+
+/*! @brief Alignment in bytes of a stack of the given words */
+#if defined(RTOS_ENABLE_UNPRIVILEGED_TASKS)
+#define RTOS_STACK_ALIGNMENT(words)	((words) * 4)	//MPU regions are aligned to their size
+#elif defined(RTOS_ENABLE_MPU_STACK_GUARD)
+#define RTOS_STACK_ALIGNMENT(words)	32	//the guard region sits right below the stack
+#else
+#define RTOS_STACK_ALIGNMENT(words)	8
+#endif
+
+/*!
+ * @brief Declares the storage of a stack for rtos_create_static_task,
+ * with room for its guard below
+ *
+ * @param name name of the storage, the stack itself is name.stack
+ * @param words size of the stack in words
+ */
+#define RTOS_STACK_DEFINE(name, words)										\
+	static struct															\
+	{																		\
+		uint32_t guard [ RTOS_STACK_GUARD_WORDS ];							\
+		uint32_t stack [ (words) ]											\
+				__attribute__((aligned(RTOS_STACK_ALIGNMENT(words))));		\
+	} name
+
 /*!
  * @brief Starts the scheduler, from this point the RTOS takes control
  * on the processor
@@ -35,17 +75,109 @@ typedef uint64_t rtos_tick_t;
  */
 void rtos_start_scheduler(void);
 
+#if RTOS_NUMBER_OF_CORES > 1
+/*!
+ * @brief Joins the scheduler from a secondary core, once core 0 called
+ * rtos_start_scheduler
+ *
+ * @param none
+ * @retval none
+ */
+void rtos_start_secondary_core(void);
+
 /*!
- * @brief Create task API function
+ * @brief Restricts the cores a task may run on
+ *
+ * @param task handle of the task
+ * @param affinity bit n set allows the task on core n
+ * @retval none
+ */
+void rtos_set_task_affinity(rtos_task_handle_t task, rtos_affinity_t affinity);
+
+/*!
+ * @brief Reschedules the calling core, the port calls it from the
+ * inter-core interrupt handler
+ *
+ * @param none
+ * @retval none
+ */
+void rtos_handle_ipi(void);
+#endif
+
+/*!
+ * @brief Create task API function, the task runs on one of the
+ * RTOS_KERNEL_STACKS stacks of RTOS_STACK_SIZE words
  *
  * @param task_body pointer to the body of the task
  * @param priority number for the RMS algorithm
  * @param autostart either autostart or start suspended
- * @retval task_handle of the task created
+ * @retval task_handle of the task created, -1 if there is no free TCB
+ * or kernel stack
  */
 rtos_task_handle_t rtos_create_task(void (*task_body)(), uint8_t priority,
         rtos_autostart_e autostart);
 
+/*!
+ * @brief Create task API function for a task on a stack of the caller,
+ * declared with RTOS_STACK_DEFINE. It takes no kernel stack, the stack
+ * is the caller's until the task is deleted
+ *
+ *	RTOS_STACK_DEFINE ( logger_stack, 256 );
+ *	rtos_create_static_task ( logger_task, 1, kAutoStart,
+ *			logger_stack.stack, 256 );
+ *
+ * @param task_body pointer to the body of the task
+ * @param priority number for the RMS algorithm
+ * @param autostart either autostart or start suspended
+ * @param stack lowest word of the stack, aligned to RTOS_STACK_ALIGNMENT
+ * @param words size of the stack, RTOS_STACK_MIN_WORDS at least, and a
+ * power of two with RTOS_ENABLE_UNPRIVILEGED_TASKS
+ * @retval task_handle of the task created, -1 if there is no free TCB
+ * or the stack is not valid
+ */
+rtos_task_handle_t rtos_create_static_task(void (*task_body)(),
+        uint8_t priority, rtos_autostart_e autostart, uint32_t *stack,
+        uint32_t words);
+
+/*!
+ * @brief Deletes a task and frees its TCB for the next task created, a
+ * task whose body returns is deleted too. Its handle becomes stale and
+ * the API ignores it. The mutexes, pool blocks and heap memory the task
+ * holds are not given back, it must release them first
+ *
+ * @param task handle of the task, it can be the calling task
+ * @retval 1 if deleted, 0 if the handle is stale or invalid
+ */
+uint8_t rtos_delete_task(rtos_task_handle_t task);
+
+/*!
+ * @brief Returns the handle of the calling task
+ *
+ * @param none
+ * @retval task handle, -1 before the scheduler starts
+ */
+rtos_task_handle_t rtos_get_task_handle(void);
+
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+/*!
+ * @brief Create task API function for a task running unprivileged. The
+ * task can only write its own stack, and from the rtos API it can only
+ * call rtos_suspend_task, rtos_activate_task, rtos_delay,
+ * rtos_delete_task on itself, and the getters rtos_get_task_handle,
+ * rtos_get_clock, rtos_get_clock32, rtos_get_cycles, rtos_get_time_ns,
+ * rtos_get_context_switches and rtos_get_stack_high_water. The two
+ * reading the SysTick go through the SVC, the others only read the
+ * kernel RAM
+ *
+ * @param task_body pointer to the body of the task
+ * @param priority number for the RMS algorithm
+ * @param autostart either autostart or start suspended
+ * @retval task_handle of the task created
+ */
+rtos_task_handle_t rtos_create_unprivileged_task(void (*task_body)(),
+        uint8_t priority, rtos_autostart_e autostart);
+#endif
+
 /*!
  * @brief Suspends the task calling this function
  *
@@ -63,20 +195,219 @@ void rtos_suspend_task(void);
 void rtos_activate_task(rtos_task_handle_t task);
 
 /*!
- * @brief Returns the rtos global tick
+ * @brief Returns the rtos global tick. It is read without masking the
+ * interrupts and can be called from any task or ISR
  *
  * @param none
  * @retval clock value
  */
 rtos_tick_t rtos_get_clock(void);
 
+/*!
+ * @brief Returns the low 32 bits of the rtos global tick, a single load
+ * for code that only needs relative time. The difference of two reads is
+ * right while they are less than 2^32 ticks apart
+ *
+ * @param none
+ * @retval clock value modulo 2^32
+ */
+uint32_t rtos_get_clock32(void);
+
+/*!
+ * @brief Returns the core cycles since the scheduler started, from the
+ * global tick and the SysTick counter. It never masks the interrupts
+ *
+ * @param none
+ * @retval cycles, they restart from the tick count on a clock change
+ */
+uint64_t rtos_get_cycles(void);
+
+/*!
+ * @brief Returns the time since the scheduler started in nanoseconds,
+ * with the resolution of the SysTick counter. It never masks the
+ * interrupts
+ *
+ * @param none
+ * @retval time in nanoseconds
+ */
+uint64_t rtos_get_time_ns(void);
+
 /*!
  * @brief Suspends the task calling this function by a certain
- * amount of time specified by the parameter ticks
+ * amount of time specified by the parameter ticks. The wait counts down
+ * in 32 bits, longer delays are cut to 2^32 - 2 ticks
  *
  * @param ticks amount of ticks for the delay
  * @retval none
  */
 void rtos_delay(rtos_tick_t ticks);
 
+/*!
+ * @brief Computes the SysTick reload from the core clock. The SysTick
+ * runs in auto reload with this value, so call it again after changing
+ * the core clock; the CPU budgets and deadlines, kept in ticks, are
+ * rescaled to it
+ *
+ * @param none
+ * @retval none
+ */
+void rtos_update_systick(void);
+
+/*!
+ * @brief Returns the number of context switches since the scheduler
+ * started, in SMP mode adding the ones of every core
+ *
+ * @param none
+ * @retval context switches
+ */
+uint32_t rtos_get_context_switches(void);
+
+#ifdef RTOS_ENABLE_CPU_BUDGET
+/*! @brief What happens to a task that runs out of its CPU budget */
+typedef enum
+{
+	kBudgetDemote, kBudgetSuspend
+} rtos_budget_action_e;
+
+/*!
+ * @brief Limits the CPU time of a task per period. The time is measured
+ * with the SysTick counter at each tick and each context switch; once
+ * the task used more than its budget it is demoted to the background
+ * priority, or suspended, until its period ends. The background priority
+ * is 0, shared with the tasks created at 0; the idle task only runs when
+ * none of them is ready. It can be called before the scheduler starts
+ *
+ * @param task handle of the task
+ * @param budget ticks of CPU time per period, 0 removes the limit
+ * @param period ticks between budget replenishments, from now
+ * @param action either demote or suspend the task on overrun
+ * @retval none
+ */
+void rtos_set_task_budget(rtos_task_handle_t task, rtos_tick_t budget,
+        rtos_tick_t period, rtos_budget_action_e action);
+
+/*!
+ * @brief Called from the SysTick when a task runs out of its budget,
+ * right after it is throttled. The default one does nothing, the
+ * application may define its own
+ *
+ * @param task handle of the task that overran
+ * @retval none
+ */
+void rtos_budget_overrun_hook(rtos_task_handle_t task);
+#endif
+
+#ifdef RTOS_ENABLE_SPORADIC_SERVER
+/*!
+ * @brief Creates a sporadic server, a task for aperiodic work. It runs
+ * at its priority while it has capacity and at the background priority 0
+ * once it has none, still ahead of the idle task. What it consumes in
+ * each busy interval is given back one period after the interval
+ * started, so for the RMS analysis it counts as a periodic task of that
+ * capacity and period. It can be called before the scheduler starts
+ *
+ * @param task_body pointer to the function that is the server body
+ * @param priority number for the RMS algorithm
+ * @param capacity ticks of CPU time at its priority per period
+ * @param period replenishment period in ticks
+ * @param autostart either autostart or start suspended
+ * @retval task_handle of the task created
+ */
+rtos_task_handle_t rtos_create_sporadic_server(void (*task_body)(),
+        uint8_t priority, rtos_tick_t capacity, rtos_tick_t period,
+        rtos_autostart_e autostart);
+#endif
+
+#ifdef RTOS_ENABLE_TIMING_STATS
+/*! @brief Timing of the jobs of a task, times are in core cycles */
+typedef struct
+{
+	rtos_tick_t release;	//tick the last job was released
+	rtos_tick_t deadline;	//tick the last job was due
+	uint32_t release_cycles;	//cycle counter at the last release
+	uint32_t start_cycles;	//cycle counter when the last job first ran
+	uint32_t completion_cycles;	//cycle counter when the last job ended
+	uint32_t max_response;	//most cycles from a release to its completion
+	uint32_t mean_response;
+	uint32_t max_start_jitter;	//spread of the cycles from release to start
+	uint32_t deadline_misses;
+	uint32_t jobs;
+} rtos_task_timing_t;
+
+/*!
+ * @brief Gives a task a relative deadline and starts its statistics.
+ * A job is released when the task gets ready after a delay, a suspension,
+ * a wait or its creation, starts when it first runs, and completes when
+ * it calls rtos_delay or rtos_suspend_task or waits on a kernel object,
+ * such as a semaphore, a queue or a pool. A wait in the middle of a job,
+ * as on a mutex held by another task, also ends it. It can be called
+ * before the scheduler starts
+ *
+ * @param task handle of the task
+ * @param deadline ticks from each release, 0 stops the statistics
+ * @retval none
+ */
+void rtos_set_task_deadline(rtos_task_handle_t task, rtos_tick_t deadline);
+
+/*!
+ * @brief Reads the timing statistics of a task
+ *
+ * @param task handle of the task
+ * @param timing where the statistics are copied
+ * @retval none
+ */
+void rtos_get_task_timing(rtos_task_handle_t task,
+        rtos_task_timing_t *timing);
+#endif
+
+#ifdef RTOS_ENABLE_PREEMPTION_THRESHOLD
+/*!
+ * @brief Sets the preemption threshold of a task. While the task runs,
+ * only the tasks of a priority above the threshold preempt it, so a group
+ * of tasks with priorities up to a common threshold never preempt each
+ * other. The threshold starts equal to the priority. It can be called
+ * before the scheduler starts
+ *
+ * @param task handle of the task
+ * @param threshold preemption threshold, lower than the priority is
+ * taken as the priority
+ * @retval none
+ */
+void rtos_set_preemption_threshold(rtos_task_handle_t task,
+        uint8_t threshold);
+#endif
+
+/*!
+ * @brief Returns the most stack the task has ever used, measured on
+ * the pattern painted by rtos_create_task
+ *
+ * @param task handle of the task
+ * @retval stack high-water mark in words, out of the size of its stack
+ */
+uint32_t rtos_get_stack_high_water(rtos_task_handle_t task);
+
+#if defined(RTOS_ENABLE_STACK_CHECK) || defined(RTOS_ENABLE_MPU_STACK_GUARD)
+/*!
+ * @brief Called when a task overflowed its stack, from the PendSV
+ * or from the MemManage fault. The default one halts, the application
+ * may define its own
+ *
+ * @param task handle of the task that overflowed
+ * @retval none
+ */
+void rtos_stack_overflow_hook(rtos_task_handle_t task);
+#endif
+
+#ifdef RTOS_ENABLE_MPU_STACK_GUARD
+/*!
+ * @brief Called from the MemManage fault when a task accessed memory
+ * it has no rights on. The default one halts, the application may
+ * define its own
+ *
+ * @param task handle of the task that faulted
+ * @retval none
+ */
+void rtos_memory_fault_hook(rtos_task_handle_t task);
+#endif
+
 #endif /* SOURCE_RTOS_H_ */
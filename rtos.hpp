@@ -0,0 +1,381 @@
+/**
+ * @file rtos.hpp
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos C++17 API
+ *
+ * Typed wrappers over the C API, the kernel does all the work and
+ * every method is an inline call to it:
+ *
+ *	rtos::Mutex mutex;
+ *	rtos::Queue<Message, 8> queue;
+ *
+ *	void producer ( void )
+ *	{
+ *		for ( ;; )
+ *		{
+ *			{
+ *				std::lock_guard<rtos::Mutex> lock ( mutex );
+ *				...
+ *			}
+ *			queue.emplace ( rtos::Duration::forever (), id, payload );
+ *			rtos::Task::delay ( std::chrono::milliseconds ( 10 ) );
+ *		}
+ *	}
+ */
+
+#ifndef SOURCE_RTOS_HPP_
+#define SOURCE_RTOS_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+extern "C"
+{
+#include "rtos.h"
+#include "rtos_config.h"
+#include "rtos_kernel.h"
+#include "rtos_mutex.h"
+#include "rtos_semaphore.h"
+}
+
+namespace rtos
+{
+
+/*! @brief std::chrono duration of one rtos tick */
+using tick = std::chrono::duration<rtos_tick_t,
+		std::ratio<RTOS_TIC_PERIOD_IN_US, 1000000>>;
+
+/*! @brief Time interval in ticks, built from any std::chrono duration */
+class Duration
+{
+public:
+	constexpr explicit Duration ( rtos_tick_t ticks ) :
+			ticks_ ( ticks )
+	{
+	}
+
+	//rounded up, so a wait is never shorter than asked
+	template<typename Rep, typename Period>
+	constexpr Duration ( std::chrono::duration<Rep, Period> duration ) :
+			ticks_ (
+					duration.count () > 0 ?
+							std::chrono::ceil<tick> ( duration ).count () : 0 )
+	{
+	}
+
+	static constexpr Duration forever ( void )
+	{
+		return Duration ( RTOS_WAIT_FOREVER );
+	}
+
+	static constexpr Duration zero ( void )
+	{
+		return Duration ( 0 );
+	}
+
+	constexpr rtos_tick_t ticks ( void ) const
+	{
+		return ticks_;
+	}
+
+private:
+	rtos_tick_t ticks_;
+};
+
+/*! @brief Handle of a task */
+class Task
+{
+public:
+	Task ( void (*body) ( ), uint8_t priority, rtos_autostart_e autostart =
+			kAutoStart ) :
+			handle_ ( rtos_create_task ( body, priority, autostart ) )
+	{
+	}
+
+	constexpr explicit Task ( rtos_task_handle_t handle ) :
+			handle_ ( handle )
+	{
+	}
+
+	bool valid ( void ) const
+	{
+		return handle_ >= 0;
+	}
+
+	rtos_task_handle_t handle ( void ) const
+	{
+		return handle_;
+	}
+
+	void activate ( void ) const
+	{
+		rtos_activate_task ( handle_ );
+	}
+
+	uint32_t stack_high_water ( void ) const
+	{
+		return rtos_get_stack_high_water ( handle_ );
+	}
+
+	/*! @brief Deletes the task, its handle becomes stale */
+	bool destroy ( void ) const
+	{
+		return rtos_delete_task ( handle_ );
+	}
+
+	/*! @brief Returns the calling task */
+	static Task self ( void )
+	{
+		return Task ( rtos_get_task_handle () );
+	}
+
+	/*! @brief Delays the calling task */
+	static void delay ( Duration duration )
+	{
+		rtos_delay ( duration.ticks () );
+	}
+
+	/*! @brief Suspends the calling task */
+	static void suspend ( void )
+	{
+		rtos_suspend_task ();
+	}
+
+	/*! @brief Returns the rtos global tick */
+	static rtos_tick_t clock ( void )
+	{
+		return rtos_get_clock ();
+	}
+
+private:
+	rtos_task_handle_t handle_;
+};
+
+/*! @brief Mutex meeting the Lockable requirements, for std::lock_guard
+ * and std::unique_lock */
+class Mutex
+{
+public:
+	constexpr Mutex ( void ) :
+			mutex_ RTOS_MUTEX_INITIALIZER
+	{
+	}
+	Mutex ( const Mutex& ) = delete;
+	Mutex& operator= ( const Mutex& ) = delete;
+
+	void lock ( void )
+	{
+		rtos_mutex_lock ( &mutex_, RTOS_WAIT_FOREVER );
+	}
+
+	bool try_lock ( void )
+	{
+		return rtos_mutex_lock ( &mutex_, 0 );
+	}
+
+	bool try_lock_for ( Duration timeout )
+	{
+		return rtos_mutex_lock ( &mutex_, timeout.ticks () );
+	}
+
+	void unlock ( void )
+	{
+		rtos_mutex_unlock ( &mutex_ );
+	}
+
+private:
+	rtos_mutex_t mutex_;
+};
+
+/*! @brief Counting semaphore with the interface of std::counting_semaphore,
+ * release adds one at a time and can be called from ISRs */
+template<uint32_t Limit = 1>
+class Semaphore
+{
+	static_assert ( Limit > 0, "a semaphore needs a count to give" );
+
+public:
+	constexpr explicit Semaphore ( uint32_t count = 0 ) :
+			semaphore_ RTOS_SEMAPHORE_INITIALIZER(count < Limit ? count : Limit, Limit)
+	{
+	}
+	Semaphore ( const Semaphore& ) = delete;
+	Semaphore& operator= ( const Semaphore& ) = delete;
+
+	void acquire ( void )
+	{
+		rtos_semaphore_take ( &semaphore_, RTOS_WAIT_FOREVER );
+	}
+
+	bool try_acquire ( void )
+	{
+		return rtos_semaphore_take ( &semaphore_, 0 );
+	}
+
+	bool try_acquire_for ( Duration timeout )
+	{
+		return rtos_semaphore_take ( &semaphore_, timeout.ticks () );
+	}
+
+	bool release ( void )
+	{
+		return rtos_semaphore_give ( &semaphore_ );
+	}
+
+private:
+	rtos_semaphore_t semaphore_;
+};
+
+/*!
+ * @brief Fixed size queue of N elements of type T. The elements are
+ * built in place in the queue storage and moved out of it, without
+ * copies nor heap. From ISRs the timeouts must be zero.
+ *
+ * The moves run inside the kernel critical section, so T must be
+ * cheap and nothrow to move.
+ */
+template<typename T, size_t N>
+class Queue
+{
+	static_assert ( N > 0, "a queue needs room for one element" );
+	static_assert ( std::is_nothrow_move_constructible<T>::value,
+			"queue elements are moved with the interrupts masked" );
+	static_assert ( std::is_nothrow_move_assignable<T>::value,
+			"pop moves the elements out with the interrupts masked" );
+
+public:
+	Queue ( void ) = default;
+	Queue ( const Queue& ) = delete;
+	Queue& operator= ( const Queue& ) = delete;
+
+	~Queue ( void )
+	{
+		while (count_)
+		{
+			slot ( head_ )->~T ();
+			head_ = next ( head_ );
+			count_ = count_ - 1;
+		}
+	}
+
+	/*!
+	 * @brief Builds an element at the back of the queue
+	 *
+	 * @param timeout time to wait for room
+	 * @param args arguments of the constructor of T
+	 * @retval true if queued, false on timeout
+	 */
+	template<typename ... Args>
+	bool emplace ( Duration timeout, Args &&... args )
+	{
+		rtos_critical_t critical;
+		if (!wait ( storage_, timeout, [this] () { return count_ < N; },
+				critical ))
+		{
+			return false;
+		}
+		new ( slot ( tail_ ) ) T ( std::forward<Args> ( args )... );
+		tail_ = next ( tail_ );
+		count_ = count_ + 1;
+		signal ( this, critical );
+		return true;
+	}
+
+	bool push ( T &&value, Duration timeout = Duration::forever () )
+	{
+		return emplace ( timeout, std::move ( value ) );
+	}
+
+	/*!
+	 * @brief Moves the element at the front of the queue out of it
+	 *
+	 * @param value where the element is moved to
+	 * @param timeout time to wait for an element
+	 * @retval true if an element was taken, false on timeout
+	 */
+	bool pop ( T &value, Duration timeout = Duration::forever () )
+	{
+		rtos_critical_t critical;
+		if (!wait ( this, timeout, [this] () { return count_ > 0; },
+				critical ))
+		{
+			return false;
+		}
+		value = std::move ( *slot ( head_ ) );
+		slot ( head_ )->~T ();
+		head_ = next ( head_ );
+		count_ = count_ - 1;
+		signal ( storage_, critical );
+		return true;
+	}
+
+	size_t size ( void ) const
+	{
+		return count_;
+	}
+
+private:
+	T* slot ( size_t index )
+	{
+		return std::launder ( reinterpret_cast<T*> ( storage_ [ index ] ) );
+	}
+
+	static size_t next ( size_t index )
+	{
+		return N - 1 == index ? 0 : index + 1;
+	}
+
+	//returns inside the critical section when ready, the waiters block on
+	//this while empty and on storage_ while full
+	template<typename Ready>
+	static bool wait ( void *object, Duration timeout, Ready ready,
+			rtos_critical_t &critical )
+	{
+		rtos_tick_t ticks = __get_IPSR () ? 0 : timeout.ticks ();
+		rtos_tick_t deadline = rtos_get_clock () + ticks;
+		critical = rtos_kernel_enter_critical ();
+		while (!ready ())
+		{
+			if (!ticks)
+			{
+				rtos_kernel_exit_critical ( critical );
+				return false;
+			}
+			if (!rtos_kernel_block ( object, ticks, critical ))
+			{
+				ticks = 0;
+			}
+			else if (RTOS_WAIT_FOREVER != ticks)
+			{
+				//another task took it first, wait for the time left
+				rtos_tick_t now = rtos_get_clock ();
+				ticks = deadline > now ? deadline - now : 0;
+			}
+			critical = rtos_kernel_enter_critical ();
+		}
+		return true;
+	}
+
+	static void signal ( void *object, rtos_critical_t critical )
+	{
+		uint8_t woken = rtos_kernel_wake ( object, 0 );
+		rtos_kernel_exit_critical ( critical );
+		if (woken)
+		{
+			rtos_kernel_yield ();
+		}
+	}
+
+	alignas(T) unsigned char storage_ [ N ] [ sizeof(T) ];
+	size_t head_ = 0;
+	size_t tail_ = 0;
+	volatile size_t count_ = 0;
+};
+
+}
+
+#endif /* SOURCE_RTOS_HPP_ */
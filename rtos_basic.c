@@ -0,0 +1,175 @@
+/**
+ * @file rtos_basic.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of rtos run-to-completion basic tasks
+ *
+ * Each level keeps a bitmap of its basic tasks with pending
+ * activations. Its kernel task runs the lowest set bit and blocks on
+ * the level while the bitmap is empty.
+ */
+
+#include "rtos_basic.h"
+#include "rtos_kernel.h"
+
+#ifdef RTOS_ENABLE_BASIC_TASKS
+
+#if RTOS_MAX_NUMBER_OF_BASIC_TASKS > 32
+#error "RTOS_MAX_NUMBER_OF_BASIC_TASKS can not exceed 32"
+#endif
+
+/**********************************************************************************/
+// Module defines
+/**********************************************************************************/
+
+#define INVALID_TASK				-1
+#define MAX_ACTIVATIONS				0xFF
+
+/**********************************************************************************/
+// Basic tasks and levels
+/**********************************************************************************/
+
+typedef struct
+{
+	uint8_t priority;
+	rtos_task_handle_t runner;	//kernel task whose stack the level shares
+	volatile uint32_t pending;	//bit n set if basic task n has activations
+} basic_level_t;
+
+static struct
+{
+	uint8_t nTasks;
+	uint8_t nLevels;
+	struct
+	{
+		void (*task_body) ( );
+		uint8_t level;
+		uint8_t activations;
+	} tasks [ RTOS_MAX_NUMBER_OF_BASIC_TASKS ];
+	basic_level_t levels [ RTOS_BASIC_TASK_LEVELS ];
+} basic =
+{ 0 };
+
+/**********************************************************************************/
+// Local methods prototypes
+/**********************************************************************************/
+
+static void
+level_task ( void );
+
+static inline uint8_t find_first_set ( uint32_t word )
+{
+	return 31 - __builtin_clz ( word & -word );
+}
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+rtos_task_handle_t rtos_create_basic_task ( void (*task_body) ( ),
+		uint8_t priority )
+{
+	uint8_t level = 0;
+	if (RTOS_MAX_NUMBER_OF_BASIC_TASKS <= basic.nTasks)
+	{
+		return INVALID_TASK;
+	}
+	while (level < basic.nLevels && basic.levels [ level ].priority != priority)
+	{
+		level++;
+	}
+	if (level == basic.nLevels)
+	{
+		rtos_critical_t critical;
+		if (RTOS_BASIC_TASK_LEVELS <= basic.nLevels)
+		{
+			return INVALID_TASK;
+		}
+		//the level must be complete before its task can run and look for it
+		critical = rtos_kernel_enter_critical ();
+		basic.levels [ level ].runner = rtos_create_task ( level_task, priority,
+				kAutoStart );
+		basic.levels [ level ].priority = priority;
+		basic.levels [ level ].pending = 0;
+		if (INVALID_TASK != basic.levels [ level ].runner)
+		{
+			basic.nLevels++;
+		}
+		rtos_kernel_exit_critical ( critical );
+		if (level == basic.nLevels)
+		{
+			return INVALID_TASK;
+		}
+	}
+	basic.tasks [ basic.nTasks ].task_body = task_body;
+	basic.tasks [ basic.nTasks ].level = level;
+	basic.tasks [ basic.nTasks ].activations = 0;
+	return RTOS_BASIC_TASK_FLAG | basic.nTasks++;
+}
+
+#ifdef RTOS_ENABLE_SOFTWARE_TIMERS
+void rtos_basic_alarm ( rtos_timer_t *timer, void *arg )
+{
+	rtos_activate_task ( ( rtos_task_handle_t ) ( uintptr_t ) arg );
+}
+#endif
+
+/**********************************************************************************/
+// Kernel services implementation
+/**********************************************************************************/
+
+//Only queues the activation, the caller dispatches. Activations past
+//MAX_ACTIVATIONS are lost
+void rtos_kernel_basic_activate ( rtos_task_handle_t task )
+{
+	uint8_t index = task & ~RTOS_BASIC_TASK_FLAG;
+	rtos_critical_t critical;
+	basic_level_t *level;
+	if (index >= basic.nTasks)
+	{
+		return;
+	}
+	level = &basic.levels [ basic.tasks [ index ].level ];
+	critical = rtos_kernel_enter_critical ();
+	if (MAX_ACTIVATIONS > basic.tasks [ index ].activations)
+	{
+		basic.tasks [ index ].activations++;
+	}
+	level->pending |= 1u << index;
+	rtos_kernel_wake ( level, 0 );
+	rtos_kernel_exit_critical ( critical );
+}
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+//Body of the kernel task of each level, the stack all its basic tasks share
+static void level_task ( void )
+{
+	rtos_task_handle_t self = rtos_get_task_handle ();
+	basic_level_t *level = basic.levels;
+	while (level->runner != self)
+	{
+		level++;
+	}
+	for ( ;; )
+	{
+		rtos_critical_t critical = rtos_kernel_enter_critical ();
+		uint8_t index;
+		if (!level->pending)
+		{
+			rtos_kernel_block ( level, RTOS_WAIT_FOREVER, critical );
+			continue;
+		}
+		index = find_first_set ( level->pending );
+		if (!--basic.tasks [ index ].activations)
+		{
+			level->pending &= ~( 1u << index );
+		}
+		rtos_kernel_exit_critical ( critical );
+		basic.tasks [ index ].task_body ();
+	}
+}
+
+#endif
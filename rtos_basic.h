@@ -0,0 +1,57 @@
+/**
+ * @file rtos_basic.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos run-to-completion basic tasks API
+ *
+ * Basic tasks run from entry to return and never block, so the ones
+ * of the same priority share the stack of a single kernel task, their
+ * preemption level. A basic task has no TCB nor saved context, only
+ * its body and a count of pending activations. Once its level runs,
+ * starting the next pending basic task is a function call and finishing
+ * one is a return plus a bit scan, without going through the PendSV.
+ * Basic tasks of one level do not preempt each other, they run in
+ * creation order.
+ */
+
+#ifndef SOURCE_RTOS_BASIC_H_
+#define SOURCE_RTOS_BASIC_H_
+
+#include "rtos.h"
+#include "rtos_config.h"
+
+#ifdef RTOS_ENABLE_BASIC_TASKS
+
+/*! @brief Handles of the basic tasks have this bit set */
+#define RTOS_BASIC_TASK_FLAG		0x40
+
+/*!
+ * @brief Creates a basic task, activated with rtos_activate_task. The
+ * first basic task of a priority also creates the kernel task of its
+ * level
+ *
+ * @param task_body function run on each activation, it must return
+ * and not call rtos_delay nor rtos_suspend_task
+ * @param priority number for the RMS algorithm
+ * @retval handle of the basic task, -1 if there is no room
+ */
+rtos_task_handle_t rtos_create_basic_task ( void (*task_body) ( ),
+		uint8_t priority );
+
+#ifdef RTOS_ENABLE_SOFTWARE_TIMERS
+#include "rtos_timer.h"
+
+/*!
+ * @brief Timer callback activating a basic task, makes a timer an alarm:
+ * rtos_timer_init ( &timer, rtos_basic_alarm, ( void * ) handle, ... )
+ *
+ * @param timer timer that expired
+ * @param arg handle of the basic task, cast to a pointer
+ * @retval none
+ */
+void rtos_basic_alarm ( rtos_timer_t *timer, void *arg );
+#endif
+
+#endif
+
+#endif /* SOURCE_RTOS_BASIC_H_ */
@@ -0,0 +1,179 @@
+/**
+ * @file rtos_bus.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of the rtos publish/subscribe message bus
+ *
+ * Each message starts with a header holding its topic and its count of
+ * references. Publishing takes one reference per subscriber that got the
+ * message, inside the critical section, so no release can free it before
+ * every subscriber has it. The subscribers wait on their topic.
+ */
+
+#include "rtos_bus.h"
+#include "rtos_kernel.h"
+
+/**********************************************************************************/
+// Type definitions
+/**********************************************************************************/
+
+typedef struct
+{
+	rtos_topic_t *topic;
+	volatile uint32_t references;
+} bus_header_t;
+
+/**********************************************************************************/
+// Local methods prototypes
+/**********************************************************************************/
+
+static inline bus_header_t *
+header_of ( void *message );
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+void *rtos_bus_alloc ( rtos_topic_t *topic, rtos_tick_t timeout )
+{
+	bus_header_t *header = rtos_pool_alloc ( topic->pool, timeout );
+	if (!header)
+	{
+		return 0;
+	}
+	header->topic = topic;
+	header->references = 0;
+	return ( uint8_t * ) header + RTOS_BUS_HEADER_SIZE;
+}
+
+uint32_t rtos_bus_publish ( void *message )
+{
+	bus_header_t *header = header_of ( message );
+	rtos_topic_t *topic = header->topic;
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	uint32_t delivered = 0;
+	uint8_t woken = 0;
+	for ( rtos_subscriber_t *subscriber = topic->subscribers; subscriber;
+			subscriber = subscriber->next )
+	{
+		if (subscriber->count == subscriber->depth)
+		{
+			subscriber->dropped++;
+			continue;
+		}
+		subscriber->slots [ ( subscriber->head + subscriber->count )
+				% subscriber->depth ] = message;
+		subscriber->count++;
+		delivered++;
+	}
+	header->references = delivered;
+	if (delivered)
+	{
+		//a single scan of the tasks wakes every subscriber waiting
+		woken = rtos_kernel_wake ( topic, 1 );
+	}
+	rtos_kernel_exit_critical ( critical );
+	if (!delivered)
+	{
+		rtos_pool_free ( topic->pool, header );
+	}
+	if (woken)
+	{
+		rtos_kernel_yield ();
+	}
+	return delivered;
+}
+
+void *rtos_bus_receive ( rtos_subscriber_t *subscriber, rtos_tick_t timeout )
+{
+	rtos_tick_t deadline = rtos_get_clock () + timeout;
+	rtos_critical_t critical;
+	void *message;
+	if (__get_IPSR ())
+	{
+		timeout = 0;
+	}
+	critical = rtos_kernel_enter_critical ();
+	while (!subscriber->count)
+	{
+		if (!timeout)
+		{
+			rtos_kernel_exit_critical ( critical );
+			return 0;
+		}
+		if (!rtos_kernel_block ( subscriber->topic, timeout, critical ))
+		{
+			timeout = 0;
+		}
+		else if (RTOS_WAIT_FOREVER != timeout)
+		{
+			rtos_tick_t now = rtos_get_clock ();
+			timeout = deadline > now ? deadline - now : 0;
+		}
+		critical = rtos_kernel_enter_critical ();
+	}
+	message = subscriber->slots [ subscriber->head ];
+	subscriber->head = ( subscriber->head + 1 ) % subscriber->depth;
+	subscriber->count--;
+	rtos_kernel_exit_critical ( critical );
+	return message;
+}
+
+void rtos_bus_release ( void *message )
+{
+	bus_header_t *header = header_of ( message );
+	uint32_t references;
+	do
+	{
+		references = __LDREXW ( &header->references ) - 1;
+	} while (__STREXW ( references, &header->references ));
+	if (!references)
+	{
+		rtos_pool_free ( header->topic->pool, header );
+	}
+}
+
+void rtos_bus_subscribe ( rtos_topic_t *topic, rtos_subscriber_t *subscriber )
+{
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	subscriber->topic = topic;
+	subscriber->next = topic->subscribers;
+	topic->subscribers = subscriber;
+	rtos_kernel_exit_critical ( critical );
+}
+
+void rtos_bus_unsubscribe ( rtos_subscriber_t *subscriber )
+{
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	rtos_subscriber_t **link = &subscriber->topic->subscribers;
+	while (*link && *link != subscriber)
+	{
+		link = &( *link )->next;
+	}
+	if (*link)
+	{
+		*link = subscriber->next;
+	}
+	rtos_kernel_exit_critical ( critical );
+	//no publisher reaches it anymore, its ring is only drained here
+	while (subscriber->count)
+	{
+		rtos_bus_release ( subscriber->slots [ subscriber->head ] );
+		subscriber->head = ( subscriber->head + 1 ) % subscriber->depth;
+		subscriber->count--;
+	}
+}
+
+uint32_t rtos_bus_get_dropped ( rtos_subscriber_t *subscriber )
+{
+	return subscriber->dropped;
+}
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+static inline bus_header_t *header_of ( void *message )
+{
+	return ( bus_header_t * ) ( ( uint8_t * ) message - RTOS_BUS_HEADER_SIZE );
+}
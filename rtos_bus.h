@@ -0,0 +1,163 @@
+/**
+ * @file rtos_bus.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos publish/subscribe message bus API
+ *
+ * A topic owns a pool of messages. The publisher fills a message in
+ * place and publishes it once; every subscriber of the topic gets a
+ * pointer to that same message, never a copy, and releases it when
+ * done. The last release gives the message back to the pool. Publishing
+ * wakes all the subscribers waiting on the topic in one pass.
+ *
+ *	RTOS_TOPIC_DEFINE ( imu_topic, sizeof(imu_sample_t), 4 );
+ *	RTOS_SUBSCRIBER_DEFINE ( fusion_inbox, 2 );
+ *
+ *	rtos_bus_subscribe ( &imu_topic, &fusion_inbox );
+ *
+ *	imu_sample_t *sample = rtos_bus_alloc ( &imu_topic, 0 );
+ *	read_imu ( sample );
+ *	rtos_bus_publish ( sample );
+ *
+ *	imu_sample_t *sample = rtos_bus_receive ( &fusion_inbox, RTOS_WAIT_FOREVER );
+ *	...
+ *	rtos_bus_release ( sample );
+ *
+ * Subscribers only read the messages, they are shared.
+ */
+
+#ifndef SOURCE_RTOS_BUS_H_
+#define SOURCE_RTOS_BUS_H_
+
+#include "rtos.h"
+#include "rtos_pool.h"
+
+/*!
+ * @brief Alignment in bytes of the payloads, the one of max_align_t, so
+ * a subscriber can load a double or an uint64_t with LDRD or VLDR
+ */
+#define RTOS_BUS_ALIGNMENT			RTOS_POOL_ALIGNMENT
+
+/*! @brief Bytes each message takes before its payload */
+#define RTOS_BUS_HEADER_SIZE		RTOS_BUS_ALIGNMENT
+
+/*! @brief Bytes each message takes in the pool of its topic */
+#define RTOS_BUS_MESSAGE_SIZE(size)	\
+	((RTOS_BUS_HEADER_SIZE + (size) + RTOS_BUS_ALIGNMENT - 1)	\
+	& ~(RTOS_BUS_ALIGNMENT - 1))
+
+/*!
+ * @brief Declares a topic and its message pool, no initialization is
+ * needed
+ *
+ * @param name name of the rtos_topic_t variable
+ * @param size size in bytes of each message
+ * @param count number of messages, published or being filled, at once
+ */
+#define RTOS_TOPIC_DEFINE(name, size, count)								\
+	RTOS_POOL_DEFINE(name##_pool, RTOS_BUS_MESSAGE_SIZE(size), (count));	\
+	rtos_topic_t name =													\
+	{ &name##_pool, 0 }
+
+/*!
+ * @brief Declares a subscriber and the ring of its pending messages
+ *
+ * @param name name of the rtos_subscriber_t variable
+ * @param depth messages it can hold before the next ones are dropped
+ */
+#define RTOS_SUBSCRIBER_DEFINE(name, depth)								\
+	static void *name##_slots [ (depth) ];									\
+	rtos_subscriber_t name =												\
+	{ 0, 0, name##_slots, (depth), 0, 0, 0 }
+
+typedef struct rtos_subscriber rtos_subscriber_t;
+
+/*! @brief Topic type, its fields are private to the bus module */
+typedef struct
+{
+	rtos_pool_t *pool;
+	rtos_subscriber_t *subscribers;
+} rtos_topic_t;
+
+/*! @brief Subscriber type, its fields are private to the bus module */
+struct rtos_subscriber
+{
+	rtos_subscriber_t *next;
+	rtos_topic_t *topic;
+	void **slots;
+	uint32_t depth;
+	uint32_t head;
+	volatile uint32_t count;
+	uint32_t dropped;
+};
+
+/*!
+ * @brief Takes a message from the pool of a topic, to be filled and
+ * published. From ISRs the timeout must be 0
+ *
+ * @param topic topic the message is for
+ * @param timeout ticks to wait for a free message, 0 to return at once,
+ * or RTOS_WAIT_FOREVER
+ * @retval the message payload, 0 if none got free before the timeout
+ */
+void *rtos_bus_alloc ( rtos_topic_t *topic, rtos_tick_t timeout );
+
+/*!
+ * @brief Hands a message to every subscriber of its topic, the ones
+ * with a full ring miss it. The publisher must not touch it afterwards.
+ * It can be called from ISRs
+ *
+ * @param message payload given by rtos_bus_alloc
+ * @retval number of subscribers that got it
+ */
+uint32_t rtos_bus_publish ( void *message );
+
+/*!
+ * @brief Takes the oldest message pending for a subscriber. From ISRs
+ * the timeout must be 0
+ *
+ * @param subscriber subscriber receiving
+ * @param timeout ticks to wait for a message, 0 to return at once, or
+ * RTOS_WAIT_FOREVER
+ * @retval the message payload, 0 on timeout
+ */
+void *rtos_bus_receive ( rtos_subscriber_t *subscriber, rtos_tick_t timeout );
+
+/*!
+ * @brief Drops the reference of a subscriber to a message, the last one
+ * frees it. It can be called from ISRs
+ *
+ * @param message payload given by rtos_bus_receive
+ * @retval none
+ */
+void rtos_bus_release ( void *message );
+
+/*!
+ * @brief Adds a subscriber to a topic, it gets the messages published
+ * from now on
+ *
+ * @param topic topic to follow
+ * @param subscriber subscriber not following any topic
+ * @retval none
+ */
+void rtos_bus_subscribe ( rtos_topic_t *topic, rtos_subscriber_t *subscriber );
+
+/*!
+ * @brief Removes a subscriber from its topic and releases its pending
+ * messages
+ *
+ * @param subscriber subscriber to remove
+ * @retval none
+ */
+void rtos_bus_unsubscribe ( rtos_subscriber_t *subscriber );
+
+/*!
+ * @brief Returns the messages a subscriber missed because its ring was
+ * full
+ *
+ * @param subscriber subscriber to check
+ * @retval messages dropped
+ */
+uint32_t rtos_bus_get_dropped ( rtos_subscriber_t *subscriber );
+
+#endif /* SOURCE_RTOS_BUS_H_ */
@@ -15,11 +15,49 @@
 /*! @brief Tick period */
 #define RTOS_TIC_PERIOD_IN_US 		(1000)
 
-/*! @brief Stack size for each task */
+/*! @brief Stack size for each task, a task using the FPU stacks 34 more words per switch */
 #define RTOS_STACK_SIZE				(100)
 
 /*! @brief Max number of tasks for runtime */
+#ifndef RTOS_MAX_NUMBER_OF_TASKS
 #define RTOS_MAX_NUMBER_OF_TASKS	(10)
+#endif
+
+/*! @brief Stacks of RTOS_STACK_SIZE words for rtos_create_task, the tasks the kernel
+ * creates included; the tasks created on a stack of their own do not take one */
+#ifndef RTOS_KERNEL_STACKS
+#define RTOS_KERNEL_STACKS			RTOS_MAX_NUMBER_OF_TASKS
+#endif
+
+/*! @brief Cores the scheduler runs on, more than one builds the SMP mode */
+#ifndef RTOS_NUMBER_OF_CORES
+#define RTOS_NUMBER_OF_CORES		(1)
+#endif
+
+/*! @brief Stack overflow check at each context switch */
+//#define RTOS_ENABLE_STACK_CHECK
+
+/*! @brief MPU stack guard configuration, needs an ARMv7-M MPU */
+//#define RTOS_ENABLE_MPU_STACK_GUARD
+#ifdef RTOS_ENABLE_MPU_STACK_GUARD
+/*! @brief Unprivileged tasks, RTOS_STACK_SIZE words must be a power of two bytes */
+//#define RTOS_ENABLE_UNPRIVILEGED_TASKS
+#endif
+
+/*! @brief Preemption thresholds, a running task is only preempted above its threshold */
+//#define RTOS_ENABLE_PREEMPTION_THRESHOLD
+
+/*! @brief CPU time budgets, a task running out of its budget is throttled until its next period */
+//#define RTOS_ENABLE_CPU_BUDGET
+#ifdef RTOS_ENABLE_CPU_BUDGET
+/*! @brief Sporadic servers, for aperiodic work at a bounded share of the CPU */
+//#define RTOS_ENABLE_SPORADIC_SERVER
+/*! @brief Pending replenishments each sporadic server keeps */
+#define RTOS_SPORADIC_REPLENISHMENTS	(4)
+#endif
+
+/*! @brief Response time, start jitter and deadline statistics of the tasks given a deadline */
+//#define RTOS_ENABLE_TIMING_STATS
 
 /*! @brief Is alive configuration */
 #define RTOS_ENABLE_IS_ALIVE
@@ -32,4 +70,53 @@
 #define RTOS_IS_ALIVE_PERIOD_IN_US  (1000000)
 #endif
 
+/*! @brief Software timers configuration */
+//#define RTOS_ENABLE_SOFTWARE_TIMERS
+#ifdef RTOS_ENABLE_SOFTWARE_TIMERS
+/*! @brief Priority of the timer task */
+#define RTOS_TIMER_TASK_PRIORITY	(5)
+/*! @brief Slots per timer wheel level, as a power of two */
+#define RTOS_TIMER_WHEEL_BITS		(6)
+/*! @brief Number of timer wheel levels */
+#define RTOS_TIMER_WHEEL_LEVELS		(4)
+#endif
+
+/*! @brief Deferred interrupt handlers configuration */
+//#define RTOS_ENABLE_DEFERRED_ISR
+#ifdef RTOS_ENABLE_DEFERRED_ISR
+/*! @brief Priority of the deferred task, above the tasks the handlers feed */
+#define RTOS_DEFERRED_ISR_PRIORITY	(6)
+#endif
+
+/*! @brief Work queue configuration */
+//#define RTOS_ENABLE_WORK_QUEUE
+#ifdef RTOS_ENABLE_WORK_QUEUE
+/*! @brief Number of worker tasks, each one takes a task and its stack */
+#define RTOS_WORK_QUEUE_WORKERS		(2)
+/*! @brief Priority of the worker tasks */
+#define RTOS_WORK_QUEUE_PRIORITY	(4)
+/*! @brief Max number of jobs queued */
+#define RTOS_WORK_QUEUE_DEPTH		(32)
+/*! @brief Max number of jobs a worker takes at once */
+#define RTOS_WORK_QUEUE_BATCH		(4)
+#endif
+
+/*! @brief Run-to-completion basic tasks configuration */
+//#define RTOS_ENABLE_BASIC_TASKS
+#ifdef RTOS_ENABLE_BASIC_TASKS
+/*! @brief Max number of basic tasks, up to 32 */
+#define RTOS_MAX_NUMBER_OF_BASIC_TASKS	(16)
+/*! @brief Max number of basic task priorities, each one takes a task and its stack */
+#define RTOS_BASIC_TASK_LEVELS			(3)
+#endif
+
+/*! @brief TLSF heap configuration */
+//#define RTOS_ENABLE_HEAP
+#ifdef RTOS_ENABLE_HEAP
+/*! @brief Linker symbol at the start of the heap region */
+#define RTOS_HEAP_START_SYMBOL		_pvHeapStart
+/*! @brief Linker symbol at the end of the heap region */
+#define RTOS_HEAP_END_SYMBOL		_pvHeapLimit
+#endif
+
 #endif /* SOURCE_RTOS_CONFIG_H_ */
@@ -0,0 +1,377 @@
+/**
+ * @file rtos_coroutine.hpp
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos stackless coroutine tasks
+ *
+ * C++20 coroutine tasks sharing the stack of the kernel task that runs
+ * them. A rtos::CoroutineRunner is the body of one kernel task: it
+ * resumes its ready coroutines by priority and blocks the kernel task
+ * when all of them wait, so the dispatcher schedules the whole group at
+ * the priority of that kernel task. A coroutine only keeps its frame,
+ * the variables alive across a co_await, usually a few tens of bytes.
+ *
+ * A coroutine must not call the blocking rtos functions, that would
+ * block its whole group, it waits with co_await instead:
+ *
+ *	rtos::Coroutine blink ( void )
+ *	{
+ *		for ( ;; )
+ *		{
+ *			toggle_led ();
+ *			co_await rtos::delay ( 500 );
+ *		}
+ *	}
+ *
+ *	rtos::CoroutineRunner runner;
+ *	void runner_task ( void ) { runner.run (); }
+ *
+ *	runner.spawn ( blink (), 1 );
+ *	rtos_create_task ( runner_task, 2, kAutoStart );
+ */
+
+#ifndef SOURCE_RTOS_COROUTINE_HPP_
+#define SOURCE_RTOS_COROUTINE_HPP_
+
+#include <coroutine>
+#include <cstddef>
+
+extern "C"
+{
+#include "rtos.h"
+#include "rtos_kernel.h"
+#ifdef RTOS_ENABLE_HEAP
+#include "rtos_heap.h"
+#endif
+}
+
+namespace rtos
+{
+
+class CoroutineRunner;
+
+/*! @brief Return type of a coroutine task */
+class Coroutine
+{
+public:
+	struct promise_type
+	{
+		Coroutine get_return_object ( void )
+		{
+			return Coroutine ( handle_t::from_promise ( *this ) );
+		}
+		std::suspend_always initial_suspend ( void ) noexcept
+		{
+			return { };
+		}
+		std::suspend_always final_suspend ( void ) noexcept
+		{
+			return { };
+		}
+		void return_void ( void )
+		{
+		}
+		void unhandled_exception ( void )
+		{
+			for ( ;; )
+				;
+		}
+#ifdef RTOS_ENABLE_HEAP
+		static void *operator new ( std::size_t size ) noexcept
+		{
+			return rtos_heap_alloc ( size );
+		}
+		static void operator delete ( void *frame )
+		{
+			rtos_heap_free ( frame );
+		}
+		static Coroutine get_return_object_on_allocation_failure ( void )
+		{
+			return Coroutine ( nullptr );
+		}
+#endif
+
+		CoroutineRunner *runner = nullptr;
+		promise_type *next = nullptr;
+		rtos_tick_t wake = 0;
+		uint8_t priority = 0;
+	};
+
+	using handle_t = std::coroutine_handle<promise_type>;
+
+	Coroutine ( Coroutine &&other ) noexcept :
+			handle ( other.handle )
+	{
+		other.handle = nullptr;
+	}
+	Coroutine ( const Coroutine& ) = delete;
+	Coroutine& operator= ( const Coroutine& ) = delete;
+
+	//a coroutine never spawned is released here, a spawned one by its runner
+	~Coroutine ( void )
+	{
+		if (handle)
+		{
+			handle.destroy ();
+		}
+	}
+
+private:
+	explicit Coroutine ( handle_t handle ) :
+			handle ( handle )
+	{
+	}
+
+	handle_t handle;
+
+	friend class CoroutineRunner;
+};
+
+/*! @brief Runs a group of coroutines on the stack of one kernel task */
+class CoroutineRunner
+{
+public:
+	/*!
+	 * @brief Adds a coroutine to the group, ready to run. Can be called
+	 * before the scheduler starts
+	 *
+	 * @param coroutine value returned by the coroutine function
+	 * @param priority among the group, higher runs first
+	 * @retval none
+	 */
+	void spawn ( Coroutine coroutine, uint8_t priority )
+	{
+		Coroutine::handle_t handle = coroutine.handle;
+		coroutine.handle = nullptr;
+		if (handle)
+		{
+			handle.promise ().runner = this;
+			handle.promise ().priority = priority;
+			make_ready ( handle.promise () );
+		}
+	}
+
+	/*!
+	 * @brief Body of the kernel task, resumes the ready coroutines and
+	 * blocks while there are none
+	 *
+	 * @param none
+	 * @retval none
+	 */
+	[[noreturn]] void run ( void )
+	{
+		for ( ;; )
+		{
+			rtos_critical_t critical = rtos_kernel_enter_critical ();
+			Coroutine::promise_type *promise = ready;
+			if (promise)
+			{
+				ready = promise->next;
+				rtos_kernel_exit_critical ( critical );
+				Coroutine::handle_t handle = Coroutine::handle_t::from_promise (
+						*promise );
+				handle.resume ();
+				if (handle.done ())
+				{
+					handle.destroy ();
+				}
+			}
+			else
+			{
+				rtos_tick_t timeout = RTOS_WAIT_FOREVER;
+				if (sleeping)
+				{
+					rtos_tick_t now = rtos_get_clock ();
+					timeout = sleeping->wake > now ? sleeping->wake - now : 0;
+				}
+				if (timeout)
+				{
+					rtos_kernel_block ( this, timeout, critical );
+				}
+				else
+				{
+					rtos_kernel_exit_critical ( critical );
+				}
+			}
+			wake_sleeping ();
+		}
+	}
+
+	/*!
+	 * @brief Queues a coroutine of the group to run, the awaitables use
+	 * it. Can be called from ISRs
+	 *
+	 * @param promise of the coroutine
+	 * @retval none
+	 */
+	void make_ready ( Coroutine::promise_type &promise )
+	{
+		rtos_critical_t critical = rtos_kernel_enter_critical ();
+		Coroutine::promise_type **link = &ready;
+		while (*link && ( *link )->priority >= promise.priority)
+		{
+			link = &( *link )->next;
+		}
+		promise.next = *link;
+		*link = &promise;
+		rtos_kernel_wake ( this, 1 );
+		rtos_kernel_exit_critical ( critical );
+	}
+
+	/*!
+	 * @brief Suspends the running coroutine of the group for some ticks,
+	 * rtos::delay uses it
+	 *
+	 * @param promise of the running coroutine
+	 * @param ticks to wait, 0 only lets the others of its priority run
+	 * @retval none
+	 */
+	void sleep ( Coroutine::promise_type &promise, rtos_tick_t ticks )
+	{
+		Coroutine::promise_type **link = &sleeping;
+		if (!ticks)
+		{
+			make_ready ( promise );
+			return;
+		}
+		promise.wake = rtos_get_clock () + ticks;
+		while (*link && ( *link )->wake <= promise.wake)
+		{
+			link = &( *link )->next;
+		}
+		promise.next = *link;
+		*link = &promise;
+	}
+
+private:
+	//the sleeping list is only touched by the runner, the ready one also by ISRs
+	void wake_sleeping ( void )
+	{
+		rtos_tick_t now;
+		if (!sleeping)
+		{
+			return;
+		}
+		now = rtos_get_clock ();
+		while (sleeping && sleeping->wake <= now)
+		{
+			Coroutine::promise_type *promise = sleeping;
+			sleeping = promise->next;
+			make_ready ( *promise );
+		}
+	}
+
+	Coroutine::promise_type *ready = nullptr;	//by priority, FIFO among equals
+	Coroutine::promise_type *sleeping = nullptr;	//by wake tick
+};
+
+/*! @brief Awaitable suspending the coroutine for some ticks */
+struct delay
+{
+	explicit delay ( rtos_tick_t ticks ) :
+			ticks ( ticks )
+	{
+	}
+	bool await_ready ( void ) const noexcept
+	{
+		return false;
+	}
+	void await_suspend ( Coroutine::handle_t handle ) const
+	{
+		handle.promise ().runner->sleep ( handle.promise (), ticks );
+	}
+	void await_resume ( void ) const noexcept
+	{
+	}
+
+	rtos_tick_t ticks;
+};
+
+/*! @brief Awaitable letting the other coroutines of the same priority run */
+inline delay yield ( void )
+{
+	return delay ( 0 );
+}
+
+/*! @brief Counting semaphore coroutines wait on with co_await */
+class CoroutineSemaphore
+{
+public:
+	explicit CoroutineSemaphore ( uint32_t count = 0 ) :
+			count ( count )
+	{
+	}
+
+	/*!
+	 * @brief Resumes the first waiting coroutine or increments the count.
+	 * Can be called from coroutines, tasks and ISRs
+	 *
+	 * @param none
+	 * @retval none
+	 */
+	void give ( void )
+	{
+		rtos_critical_t critical = rtos_kernel_enter_critical ();
+		Coroutine::promise_type *promise = head;
+		if (promise)
+		{
+			head = promise->next;
+			promise->runner->make_ready ( *promise );
+		}
+		else
+		{
+			count++;
+		}
+		rtos_kernel_exit_critical ( critical );
+		rtos_kernel_yield ();
+	}
+
+	struct awaiter
+	{
+		bool await_ready ( void ) const noexcept
+		{
+			return false;
+		}
+		//returns false to go on without suspending when the count was taken
+		bool await_suspend ( Coroutine::handle_t handle ) const
+		{
+			rtos_critical_t critical = rtos_kernel_enter_critical ();
+			bool wait = !semaphore.count;
+			if (wait)
+			{
+				Coroutine::promise_type **link = &semaphore.head;
+				while (*link)
+				{
+					link = &( *link )->next;
+				}
+				handle.promise ().next = nullptr;
+				*link = &handle.promise ();
+			}
+			else
+			{
+				semaphore.count--;
+			}
+			rtos_kernel_exit_critical ( critical );
+			return wait;
+		}
+		void await_resume ( void ) const noexcept
+		{
+		}
+
+		CoroutineSemaphore &semaphore;
+	};
+
+	awaiter operator co_await ( void )
+	{
+		return awaiter
+		{ *this };
+	}
+
+private:
+	uint32_t count;
+	Coroutine::promise_type *head = nullptr;	//waiting coroutines, FIFO
+};
+
+}
+
+#endif /* SOURCE_RTOS_COROUTINE_HPP_ */
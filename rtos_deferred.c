@@ -0,0 +1,152 @@
+/**
+ * @file rtos_deferred.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of the rtos deferred interrupt handlers
+ *
+ * The pending handlers are pushed on a LIFO with LDREX/STREX, as the
+ * free lists of the pools, so ISRs of any priority can raise them
+ * without masking the interrupts. The deferred task takes the whole
+ * list at once, leaving it empty, and runs it in raise order.
+ */
+
+#include "rtos_deferred.h"
+#include "rtos_kernel.h"
+
+#ifdef RTOS_ENABLE_DEFERRED_ISR
+
+/**********************************************************************************/
+// Pending list
+/**********************************************************************************/
+
+static struct
+{
+	rtos_deferred_t *volatile head;	//last raised first
+	uint32_t wakeups;
+} deferred_list =
+{ 0 };
+
+/**********************************************************************************/
+// Local methods prototypes
+/**********************************************************************************/
+
+static rtos_deferred_t *
+take_all ( void );
+static void
+deferred_task ( void );
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+void rtos_deferred_init ( rtos_deferred_t *deferred,
+		rtos_deferred_handler_t handler, void *arg )
+{
+	deferred->next = 0;
+	deferred->handler = handler;
+	deferred->arg = arg;
+	deferred->pending = 0;
+}
+
+uint8_t rtos_deferred_raise ( rtos_deferred_t *deferred )
+{
+	rtos_deferred_t *head;
+	//an ISR raising it in between makes the store fail, only one raise queues it
+	do
+	{
+		if (__LDREXW ( &deferred->pending ))
+		{
+			__CLREX ();
+			return 0;
+		}
+	} while (__STREXW ( 1, &deferred->pending ));
+	do
+	{
+		head = ( rtos_deferred_t * ) __LDREXW (
+				( volatile uint32_t * ) &deferred_list.head );
+		deferred->next = head;
+	} while (__STREXW ( ( uint32_t ) deferred,
+			( volatile uint32_t * ) &deferred_list.head ));
+	//the task is awake while the list is not empty, only the first raise wakes it
+	if (!head)
+	{
+		rtos_critical_t critical = rtos_kernel_enter_critical ();
+		uint8_t woken = rtos_kernel_wake ( &deferred_list, 0 );
+		rtos_kernel_exit_critical ( critical );
+		if (woken)
+		{
+			rtos_kernel_yield ();
+		}
+	}
+	return 1;
+}
+
+uint32_t rtos_deferred_get_wakeups ( void )
+{
+	return deferred_list.wakeups;
+}
+
+/**********************************************************************************/
+// Kernel services implementation
+/**********************************************************************************/
+
+void rtos_deferred_service_init ( void )
+{
+	rtos_create_task ( deferred_task, RTOS_DEFERRED_ISR_PRIORITY, kAutoStart );
+}
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+static rtos_deferred_t *take_all ( void )
+{
+	rtos_deferred_t *head;
+	do
+	{
+		head = ( rtos_deferred_t * ) __LDREXW (
+				( volatile uint32_t * ) &deferred_list.head );
+	} while (__STREXW ( 0, ( volatile uint32_t * ) &deferred_list.head ));
+	return head;
+}
+
+//A handler is no longer pending once taken, so it can be raised again while it runs
+static void deferred_task ( void )
+{
+	for ( ;; )
+	{
+		rtos_deferred_t *pending = take_all ();
+		rtos_deferred_t *ordered = 0;
+		if (!pending)
+		{
+			rtos_critical_t critical = rtos_kernel_enter_critical ();
+			if (deferred_list.head)
+			{
+				rtos_kernel_exit_critical ( critical );
+			}
+			else
+			{
+				rtos_kernel_block ( &deferred_list, RTOS_WAIT_FOREVER,
+						critical );
+				deferred_list.wakeups++;
+			}
+			continue;
+		}
+		while (pending)
+		{
+			rtos_deferred_t *next = pending->next;
+			pending->next = ordered;
+			ordered = pending;
+			pending = next;
+		}
+		while (ordered)
+		{
+			rtos_deferred_t *deferred = ordered;
+			ordered = deferred->next;
+			deferred->pending = 0;
+			deferred->handler ( deferred->arg );
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ * @file rtos_deferred.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos deferred interrupt handlers API
+ *
+ * An ISR does the urgent part of its work and raises a deferred
+ * handler, its bottom half, which the deferred task runs at
+ * RTOS_DEFERRED_ISR_PRIORITY. Raising is lock free and only enters
+ * the kernel when the pending list was empty, to wake the task; the
+ * handlers raised while the task is awake are picked up in the same
+ * switch. A handler raised again before it runs runs once.
+ *
+ *	static rtos_deferred_t uart_rx = RTOS_DEFERRED_INITIALIZER ( parse_rx, 0 );
+ *
+ *	void UART0_RX_TX_IRQHandler ( void )
+ *	{
+ *		copy_rx_fifo ();
+ *		rtos_deferred_raise ( &uart_rx );
+ *	}
+ */
+
+#ifndef SOURCE_RTOS_DEFERRED_H_
+#define SOURCE_RTOS_DEFERRED_H_
+
+#include "rtos.h"
+#include "rtos_config.h"
+
+#ifdef RTOS_ENABLE_DEFERRED_ISR
+
+/*! @brief Deferred handler type, runs in the deferred task */
+typedef void (*rtos_deferred_handler_t) ( void *arg );
+
+/*! @brief Deferred handler, its fields are private to the module */
+typedef struct rtos_deferred
+{
+	struct rtos_deferred *next;
+	rtos_deferred_handler_t handler;
+	void *arg;
+	volatile uint32_t pending;
+} rtos_deferred_t;
+
+/*! @brief Static initializer of a deferred handler */
+#define RTOS_DEFERRED_INITIALIZER(handler, arg)	{ 0, (handler), (arg), 0 }
+
+/*!
+ * @brief Sets up a deferred handler, not pending
+ *
+ * @param deferred deferred handler to set up
+ * @param handler function to run
+ * @param arg argument given to the function
+ * @retval none
+ */
+void rtos_deferred_init ( rtos_deferred_t *deferred,
+		rtos_deferred_handler_t handler, void *arg );
+
+/*!
+ * @brief Makes a deferred handler pending, meant for ISRs though tasks
+ * can call it too
+ *
+ * @param deferred deferred handler to run
+ * @retval 1 if queued, 0 if it was already pending
+ */
+uint8_t rtos_deferred_raise ( rtos_deferred_t *deferred );
+
+/*!
+ * @brief Returns the number of times the deferred task was woken, the
+ * raises per wakeup tell how much the batching saves
+ *
+ * @param none
+ * @retval wakeups of the deferred task
+ */
+uint32_t rtos_deferred_get_wakeups ( void );
+
+#endif
+
+#endif /* SOURCE_RTOS_DEFERRED_H_ */
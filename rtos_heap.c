@@ -0,0 +1,419 @@
+/**
+ * @file rtos_heap.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of rtos TLSF heap
+ *
+ * Free blocks are kept in lists segregated by a first level (power
+ * of two) and a second level (linear split of that power of two)
+ * index. Two bitmaps tell which lists are not empty, so finding a
+ * fitting block is a couple of bit scans and never walks a list.
+ * Neighbour blocks are merged on release using the physical links.
+ */
+
+#include "rtos_heap.h"
+#include "rtos_kernel.h"
+
+#ifdef RTOS_ENABLE_HEAP
+
+/**********************************************************************************/
+// Module defines
+/**********************************************************************************/
+
+#define HEAP_ALIGN				8
+#define HEAP_ALIGN_SHIFT		3
+#define SL_BITS					4
+#define SL_COUNT				(1 << SL_BITS)
+#define FL_SHIFT				(SL_BITS + HEAP_ALIGN_SHIFT)
+#define FL_MAX					18	//blocks up to 256 KB, the whole SRAM of the K64F
+#define FL_COUNT				(FL_MAX - FL_SHIFT + 1)
+#define SMALL_BLOCK				(1 << FL_SHIFT)
+
+#define HEADER_SIZE				(sizeof(heap_block_t) - 2 * sizeof(heap_block_t *))
+#define MIN_BLOCK				(2 * sizeof(heap_block_t *))
+#define MAX_BLOCK				((1 << FL_MAX) - HEAP_ALIGN)
+
+//size word: bit 0 free, bit 1 previous block free, bits 2..17 size,
+//bits 18..31 owner task handle packed plus one (0 when no task)
+#define BLOCK_FREE				0x00000001
+#define BLOCK_PREV_FREE			0x00000002
+#define BLOCK_SIZE_MASK			0x0003FFFC
+#define BLOCK_OWNER_MASK		0xFFFC0000
+#define BLOCK_OWNER_SHIFT		18
+
+//task handles hold the slot in bits 0..5 and the generation in bits 8..14, the
+//packed owner keeps both in 13 bits, so a free after the slot is reused is told apart
+#define OWNER_SLOT_MASK			0x3F
+#define OWNER_GENERATION_SHIFT	2
+#define OWNER_PACK(task)		(((uint32_t)(task) & OWNER_SLOT_MASK)			\
+		| ((uint32_t)(task) & ~0xFFu) >> OWNER_GENERATION_SHIFT)
+#define OWNER_UNPACK(owner)		((rtos_task_handle_t)(((owner) & OWNER_SLOT_MASK)	\
+		| ((owner) & ~OWNER_SLOT_MASK) << OWNER_GENERATION_SHIFT))
+
+#define ALIGN_UP(x)				(((x) + HEAP_ALIGN - 1) & ~(HEAP_ALIGN - 1))
+
+/**********************************************************************************/
+// Type definitions
+/**********************************************************************************/
+
+typedef struct heap_block
+{
+	struct heap_block *prev_phys;	//block physically before, valid if it is free
+	uint32_t size;
+	//only in free blocks, overlapping the payload of used ones
+	struct heap_block *next_free;
+	struct heap_block *prev_free;
+} heap_block_t;
+
+/**********************************************************************************/
+// Heap control
+/**********************************************************************************/
+
+extern uint8_t RTOS_HEAP_START_SYMBOL [ ];
+extern uint8_t RTOS_HEAP_END_SYMBOL [ ];
+
+static struct
+{
+	uint8_t initialized;
+	uint32_t fl_bitmap;
+	uint32_t sl_bitmap [ FL_COUNT ];
+	heap_block_t *blocks [ FL_COUNT ] [ SL_COUNT ];
+	uint32_t total_bytes;
+	uint32_t free_bytes;
+	uint32_t min_free_bytes;
+	uint32_t free_blocks;
+	uint32_t used_blocks;
+} heap =
+{ 0 };
+
+/**********************************************************************************/
+// Local methods prototypes
+/**********************************************************************************/
+
+static void
+heap_init ( void );
+static void
+mapping_insert ( uint32_t size, uint8_t *fl, uint8_t *sl );
+static heap_block_t *
+search_suitable ( uint32_t size, uint8_t *fl, uint8_t *sl );
+static void
+insert_free ( heap_block_t *block );
+static void
+remove_free ( heap_block_t *block, uint8_t fl, uint8_t sl );
+static void
+remove_free_block ( heap_block_t *block );
+
+/**********************************************************************************/
+// Block helpers
+/**********************************************************************************/
+
+static inline uint32_t block_size ( heap_block_t *block )
+{
+	return block->size & BLOCK_SIZE_MASK;
+}
+
+static inline void block_set_size ( heap_block_t *block, uint32_t size )
+{
+	block->size = ( block->size & ~BLOCK_SIZE_MASK ) | size;
+}
+
+static inline heap_block_t *block_next ( heap_block_t *block )
+{
+	return ( heap_block_t * ) ( ( uint8_t * ) block + HEADER_SIZE
+			+ block_size ( block ) );
+}
+
+static inline void *block_payload ( heap_block_t *block )
+{
+	return ( uint8_t * ) block + HEADER_SIZE;
+}
+
+static inline heap_block_t *block_from_payload ( void *payload )
+{
+	return ( heap_block_t * ) ( ( uint8_t * ) payload - HEADER_SIZE );
+}
+
+static inline uint8_t find_last_set ( uint32_t word )
+{
+	return 31 - __CLZ ( word );
+}
+
+static inline uint8_t find_first_set ( uint32_t word )
+{
+	return find_last_set ( word & -word );
+}
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+void *rtos_heap_alloc ( size_t size )
+{
+	heap_block_t *block;
+	uint8_t fl, sl;
+	uint32_t adjusted = ALIGN_UP(size);
+	rtos_critical_t critical;
+	rtos_task_handle_t owner;
+	if (!size || size > MAX_BLOCK)
+	{
+		return 0;
+	}
+	if (adjusted < MIN_BLOCK)
+	{
+		adjusted = MIN_BLOCK;
+	}
+	critical = rtos_kernel_enter_critical ();
+	if (!heap.initialized)
+	{
+		heap_init ();
+	}
+	block = search_suitable ( adjusted, &fl, &sl );
+	if (!block)
+	{
+		rtos_kernel_exit_critical ( critical );
+		return 0;
+	}
+	remove_free ( block, fl, sl );
+	heap.free_blocks--;
+	if (block_size ( block ) >= adjusted + HEADER_SIZE + MIN_BLOCK)
+	{
+		heap_block_t *remaining = ( heap_block_t * ) ( ( uint8_t * ) block
+				+ HEADER_SIZE + adjusted );
+		remaining->size = BLOCK_FREE;
+		block_set_size ( remaining,
+				block_size ( block ) - adjusted - HEADER_SIZE );
+		block_set_size ( block, adjusted );
+		remaining->prev_phys = block;
+		block_next ( remaining )->prev_phys = remaining;
+		insert_free ( remaining );
+		heap.free_blocks++;
+		heap.free_bytes -= HEADER_SIZE;
+	}
+	else
+	{
+		block_next ( block )->size &= ~BLOCK_PREV_FREE;
+	}
+	block->size &= ~BLOCK_FREE;
+	owner = rtos_get_task_handle ();
+	block->size = ( block->size & ~BLOCK_OWNER_MASK )
+			| ( 0 > owner ? 0 : ( OWNER_PACK(owner) + 1 ) << BLOCK_OWNER_SHIFT );
+	heap.free_bytes -= block_size ( block );
+	heap.used_blocks++;
+	if (heap.free_bytes < heap.min_free_bytes)
+	{
+		heap.min_free_bytes = heap.free_bytes;
+	}
+	rtos_kernel_heap_account ( owner, block_size ( block ) );
+	rtos_kernel_exit_critical ( critical );
+	return block_payload ( block );
+}
+
+void rtos_heap_free ( void *payload )
+{
+	heap_block_t *block;
+	heap_block_t *next;
+	rtos_critical_t critical;
+	if (!payload)
+	{
+		return;
+	}
+	block = block_from_payload ( payload );
+	critical = rtos_kernel_enter_critical ();
+	if (block->size >> BLOCK_OWNER_SHIFT)
+	{
+		rtos_kernel_heap_account (
+				OWNER_UNPACK(( block->size >> BLOCK_OWNER_SHIFT ) - 1),
+				-( int32_t ) block_size ( block ) );
+	}
+	heap.free_bytes += block_size ( block );
+	heap.used_blocks--;
+	block->size = ( block->size & ( BLOCK_SIZE_MASK | BLOCK_PREV_FREE ) )
+			| BLOCK_FREE;
+	if (block->size & BLOCK_PREV_FREE)
+	{
+		heap_block_t *prev = block->prev_phys;
+		remove_free_block ( prev );
+		block_set_size ( prev,
+				block_size ( prev ) + HEADER_SIZE + block_size ( block ) );
+		block = prev;
+		heap.free_blocks--;
+		heap.free_bytes += HEADER_SIZE;
+	}
+	next = block_next ( block );
+	if (next->size & BLOCK_FREE)
+	{
+		remove_free_block ( next );
+		block_set_size ( block,
+				block_size ( block ) + HEADER_SIZE + block_size ( next ) );
+		heap.free_blocks--;
+		heap.free_bytes += HEADER_SIZE;
+	}
+	next = block_next ( block );
+	next->prev_phys = block;
+	next->size |= BLOCK_PREV_FREE;
+	insert_free ( block );
+	heap.free_blocks++;
+	rtos_kernel_exit_critical ( critical );
+}
+
+uint32_t rtos_heap_get_task_usage ( rtos_task_handle_t task )
+{
+	return rtos_kernel_heap_usage ( task );
+}
+
+//Only walks the highest non empty list to find the largest free block
+void rtos_heap_get_stats ( rtos_heap_stats_t *stats )
+{
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	if (!heap.initialized)
+	{
+		heap_init ();
+	}
+	stats->total_bytes = heap.total_bytes;
+	stats->free_bytes = heap.free_bytes;
+	stats->min_free_bytes = heap.min_free_bytes;
+	stats->free_blocks = heap.free_blocks;
+	stats->used_blocks = heap.used_blocks;
+	stats->largest_free_block = 0;
+	if (heap.fl_bitmap)
+	{
+		uint8_t fl = find_last_set ( heap.fl_bitmap );
+		uint8_t sl = find_last_set ( heap.sl_bitmap [ fl ] );
+		for ( heap_block_t *block = heap.blocks [ fl ] [ sl ]; block; block =
+				block->next_free )
+		{
+			if (block_size ( block ) > stats->largest_free_block)
+			{
+				stats->largest_free_block = block_size ( block );
+			}
+		}
+	}
+	stats->fragmentation =
+			heap.free_bytes ?
+					100
+							- ( uint8_t ) ( ( uint64_t ) stats->largest_free_block
+									* 100 / heap.free_bytes ) :
+					0;
+	rtos_kernel_exit_critical ( critical );
+}
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+//The region becomes one free block closed by a zero sized used block
+static void heap_init ( void )
+{
+	uint32_t start = ALIGN_UP(( uint32_t ) RTOS_HEAP_START_SYMBOL);
+	uint32_t end = ( uint32_t ) RTOS_HEAP_END_SYMBOL & ~( HEAP_ALIGN - 1 );
+	uint32_t size = end - start - 2 * HEADER_SIZE;
+	heap_block_t *block = ( heap_block_t * ) start;
+	heap_block_t *sentinel;
+	if (size > MAX_BLOCK)
+	{
+		size = MAX_BLOCK;
+	}
+	block->prev_phys = 0;
+	block->size = BLOCK_FREE | size;
+	sentinel = block_next ( block );
+	sentinel->prev_phys = block;
+	sentinel->size = BLOCK_PREV_FREE;
+	insert_free ( block );
+	heap.total_bytes = size;
+	heap.free_bytes = size;
+	heap.min_free_bytes = size;
+	heap.free_blocks = 1;
+	heap.initialized = 1;
+}
+
+static void mapping_insert ( uint32_t size, uint8_t *fl, uint8_t *sl )
+{
+	if (size < SMALL_BLOCK)
+	{
+		*fl = 0;
+		*sl = size >> HEAP_ALIGN_SHIFT;
+	}
+	else
+	{
+		uint8_t bit = find_last_set ( size );
+		*sl = ( size >> ( bit - SL_BITS ) ) ^ SL_COUNT;
+		*fl = bit - FL_SHIFT + 1;
+	}
+}
+
+//Rounds the size up to the next list start, so any block found fits
+static heap_block_t *search_suitable ( uint32_t size, uint8_t *fl,
+		uint8_t *sl )
+{
+	uint32_t sl_map;
+	if (size >= SMALL_BLOCK)
+	{
+		size += ( 1 << ( find_last_set ( size ) - SL_BITS ) ) - 1;
+	}
+	mapping_insert ( size, fl, sl );
+	if (*fl >= FL_COUNT)
+	{
+		return 0;
+	}
+	sl_map = heap.sl_bitmap [ *fl ] & ( ~0u << *sl );
+	if (!sl_map)
+	{
+		uint32_t fl_map = heap.fl_bitmap & ( ~0u << ( *fl + 1 ) );
+		if (!fl_map)
+		{
+			return 0;
+		}
+		*fl = find_first_set ( fl_map );
+		sl_map = heap.sl_bitmap [ *fl ];
+	}
+	*sl = find_first_set ( sl_map );
+	return heap.blocks [ *fl ] [ *sl ];
+}
+
+static void insert_free ( heap_block_t *block )
+{
+	uint8_t fl, sl;
+	mapping_insert ( block_size ( block ), &fl, &sl );
+	block->prev_free = 0;
+	block->next_free = heap.blocks [ fl ] [ sl ];
+	if (block->next_free)
+	{
+		block->next_free->prev_free = block;
+	}
+	heap.blocks [ fl ] [ sl ] = block;
+	heap.fl_bitmap |= 1u << fl;
+	heap.sl_bitmap [ fl ] |= 1u << sl;
+}
+
+static void remove_free ( heap_block_t *block, uint8_t fl, uint8_t sl )
+{
+	if (block->next_free)
+	{
+		block->next_free->prev_free = block->prev_free;
+	}
+	if (block->prev_free)
+	{
+		block->prev_free->next_free = block->next_free;
+	}
+	else
+	{
+		heap.blocks [ fl ] [ sl ] = block->next_free;
+		if (!block->next_free)
+		{
+			heap.sl_bitmap [ fl ] &= ~( 1u << sl );
+			if (!heap.sl_bitmap [ fl ])
+			{
+				heap.fl_bitmap &= ~( 1u << fl );
+			}
+		}
+	}
+}
+
+static void remove_free_block ( heap_block_t *block )
+{
+	uint8_t fl, sl;
+	mapping_insert ( block_size ( block ), &fl, &sl );
+	remove_free ( block, fl, sl );
+}
+
+#endif
@@ -0,0 +1,65 @@
+/**
+ * @file rtos_heap.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos real-time heap API
+ *
+ * Two-Level Segregated Fit heap placed in a linker defined region.
+ * Allocation and release take a bounded time regardless of the
+ * heap state, and the bytes each task allocates are accounted in
+ * its TCB.
+ */
+
+#ifndef SOURCE_RTOS_HEAP_H_
+#define SOURCE_RTOS_HEAP_H_
+
+#include "rtos.h"
+#include "stddef.h"
+
+/*! @brief Heap statistics type */
+typedef struct
+{
+	uint32_t total_bytes;	//bytes available for blocks after init
+	uint32_t free_bytes;	//bytes in free blocks
+	uint32_t min_free_bytes;	//lowest free_bytes ever seen
+	uint32_t largest_free_block;	//biggest allocation that can succeed now
+	uint32_t free_blocks;	//number of free blocks
+	uint32_t used_blocks;	//number of allocated blocks
+	uint8_t fragmentation;	//percent of free bytes not in the largest block
+} rtos_heap_stats_t;
+
+/*!
+ * @brief Allocates a block from the heap, the block belongs to the
+ * calling task. It can be called from ISRs
+ *
+ * @param size bytes requested
+ * @retval the block, 8 bytes aligned, or 0 if there is no room
+ */
+void *rtos_heap_alloc ( size_t size );
+
+/*!
+ * @brief Releases a block, the owner task is credited even if another
+ * task frees it. It can be called from ISRs
+ *
+ * @param block block returned by rtos_heap_alloc, 0 is ignored
+ * @retval none
+ */
+void rtos_heap_free ( void *block );
+
+/*!
+ * @brief Returns the heap bytes currently allocated by a task
+ *
+ * @param task handle of the task
+ * @retval bytes owned by the task
+ */
+uint32_t rtos_heap_get_task_usage ( rtos_task_handle_t task );
+
+/*!
+ * @brief Fills the heap statistics
+ *
+ * @param stats where to store the statistics
+ * @retval none
+ */
+void rtos_heap_get_stats ( rtos_heap_stats_t *stats );
+
+#endif /* SOURCE_RTOS_HEAP_H_ */
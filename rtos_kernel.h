@@ -0,0 +1,175 @@
+/**
+ * @file rtos_kernel.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos kernel services
+ *
+ * These are the services the rtos modules (timers, pools...)
+ * use to block and wake tasks. They are not part of the
+ * application API.
+ */
+
+#ifndef SOURCE_RTOS_KERNEL_H_
+#define SOURCE_RTOS_KERNEL_H_
+
+#include "rtos.h"
+#include "rtos_config.h"
+#include "fsl_common.h"
+
+/*! @brief Saved interrupt state of a critical section */
+typedef uint32_t rtos_critical_t;
+
+#if RTOS_NUMBER_OF_CORES > 1
+/*!
+ * @brief Enters a critical section by masking the interrupts and taking
+ * the kernel spinlock, it can be nested
+ *
+ * @param none
+ * @retval interrupt state to give back to rtos_kernel_exit_critical
+ */
+rtos_critical_t rtos_kernel_enter_critical ( void );
+
+/*!
+ * @brief Leaves a critical section restoring the interrupt state and
+ * releasing the kernel spinlock at the outermost level
+ *
+ * @param critical state returned by rtos_kernel_enter_critical
+ * @retval none
+ */
+void rtos_kernel_exit_critical ( rtos_critical_t critical );
+#else
+
+/*!
+ * @brief Enters a critical section by masking the interrupts
+ *
+ * @param none
+ * @retval interrupt state to give back to rtos_kernel_exit_critical
+ */
+static inline rtos_critical_t rtos_kernel_enter_critical ( void )
+{
+	rtos_critical_t critical = __get_PRIMASK ();
+	__disable_irq ();
+	return critical;
+}
+
+/*!
+ * @brief Leaves a critical section restoring the interrupt state
+ *
+ * @param critical state returned by rtos_kernel_enter_critical
+ * @retval none
+ */
+static inline void rtos_kernel_exit_critical ( rtos_critical_t critical )
+{
+	__set_PRIMASK ( critical );
+}
+#endif
+
+/*!
+ * @brief Blocks the calling task on a kernel object. Must be called
+ * inside a critical section, which is left before switching tasks
+ *
+ * @param object address identifying what the task waits for
+ * @param timeout ticks to wait or RTOS_WAIT_FOREVER
+ * @param critical state returned by rtos_kernel_enter_critical
+ * @retval 1 if woken by rtos_kernel_wake, 0 on timeout
+ */
+uint8_t rtos_kernel_block ( void *object, rtos_tick_t timeout,
+		rtos_critical_t critical );
+
+/*!
+ * @brief Makes ready the tasks blocked on a kernel object. It does not
+ * switch tasks, so it can be used from ISRs and critical sections
+ *
+ * @param object address the tasks are blocked on
+ * @param wake_all 0 to wake only the highest priority task, else all
+ * @retval number of tasks woken
+ */
+uint8_t rtos_kernel_wake ( void *object, uint8_t wake_all );
+
+/*!
+ * @brief Lets a higher priority ready task run. From an ISR the
+ * switch happens when the ISR returns
+ *
+ * @param none
+ * @retval none
+ */
+void rtos_kernel_yield ( void );
+
+/*!
+ * @brief Returns the TCB slot of the task running, it identifies the
+ * task while it lives but, unlike its handle, carries no generation
+ *
+ * @param none
+ * @retval slot of the running task, -1 if none
+ */
+rtos_task_handle_t rtos_kernel_current_task ( void );
+
+#ifdef RTOS_ENABLE_SOFTWARE_TIMERS
+/*!
+ * @brief Creates the timer task, called by rtos_start_scheduler
+ *
+ * @param none
+ * @retval none
+ */
+void rtos_timer_service_init ( void );
+
+/*!
+ * @brief Advances the timer wheel, called by the SysTick handler
+ *
+ * @param none
+ * @retval none
+ */
+void rtos_timer_service_tick ( void );
+#endif
+
+#ifdef RTOS_ENABLE_DEFERRED_ISR
+/*!
+ * @brief Creates the deferred task, called by rtos_start_scheduler
+ *
+ * @param none
+ * @retval none
+ */
+void rtos_deferred_service_init ( void );
+#endif
+
+#ifdef RTOS_ENABLE_WORK_QUEUE
+/*!
+ * @brief Creates the worker tasks, called by rtos_start_scheduler
+ *
+ * @param none
+ * @retval none
+ */
+void rtos_work_queue_init ( void );
+#endif
+
+#ifdef RTOS_ENABLE_BASIC_TASKS
+/*!
+ * @brief Queues an activation of a basic task and wakes its level,
+ * called by rtos_activate_task
+ *
+ * @param task handle of the basic task
+ * @retval none
+ */
+void rtos_kernel_basic_activate ( rtos_task_handle_t task );
+#endif
+
+#ifdef RTOS_ENABLE_HEAP
+/*!
+ * @brief Adds to the heap bytes owned by a task
+ *
+ * @param task handle of the owner, ignored if stale or invalid
+ * @param bytes amount to add, negative when released
+ * @retval none
+ */
+void rtos_kernel_heap_account ( rtos_task_handle_t task, int32_t bytes );
+
+/*!
+ * @brief Returns the heap bytes owned by a task
+ *
+ * @param task handle of the task
+ * @retval bytes owned, 0 for an invalid handle
+ */
+uint32_t rtos_kernel_heap_usage ( rtos_task_handle_t task );
+#endif
+
+#endif /* SOURCE_RTOS_KERNEL_H_ */
@@ -0,0 +1,166 @@
+/**
+ * @file rtos_mutex.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of rtos mutex
+ *
+ * The state word holds the owner and a flag set while tasks wait. The
+ * fast paths take a free mutex and release one without the flag with
+ * LDREX/STREX, in the calling task. The slow paths run in the kernel
+ * critical section, which keeps the flag in step with the count of
+ * waiters, and still update the state with LDREX/STREX as the fast paths
+ * run outside it.
+ */
+
+#include "rtos_mutex.h"
+#include "rtos_kernel.h"
+
+/**********************************************************************************/
+// Module defines
+/**********************************************************************************/
+
+#define MUTEX_WAITING				0x80000000u
+#define MUTEX_OWNER_MASK			0x7FFFFFFFu
+#define MUTEX_NO_TASK				MUTEX_OWNER_MASK	//owner before the scheduler starts
+
+/**********************************************************************************/
+// Local methods prototypes
+/**********************************************************************************/
+
+static inline uint32_t
+caller_owner ( void );
+
+static uint8_t
+state_update ( rtos_mutex_t *mutex, uint32_t expected, uint32_t value );
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+void rtos_mutex_init ( rtos_mutex_t *mutex )
+{
+	mutex->state = 0;
+	mutex->waiters = 0;
+}
+
+uint8_t rtos_mutex_lock ( rtos_mutex_t *mutex, rtos_tick_t timeout )
+{
+	uint32_t owner = caller_owner ();
+	rtos_tick_t deadline;
+	rtos_critical_t critical;
+	if (state_update ( mutex, 0, owner ))
+	{
+		__DMB ();
+		return 1;
+	}
+	deadline = rtos_get_clock () + timeout;
+	critical = rtos_kernel_enter_critical ();
+	for ( ;; )
+	{
+		uint32_t state = mutex->state;
+		uint8_t woken = 1;
+		if (!( state & MUTEX_OWNER_MASK ))
+		{
+			if (state_update ( mutex, state, state | owner ))
+			{
+				break;
+			}
+			continue;
+		}
+		if (!timeout)
+		{
+			rtos_kernel_exit_critical ( critical );
+			return 0;
+		}
+		mutex->waiters++;
+		if (state_update ( mutex, state, state | MUTEX_WAITING ))
+		{
+			//the owner now releases it through the slow path, which wakes us
+			woken = rtos_kernel_block ( mutex, timeout, critical );
+			critical = rtos_kernel_enter_critical ();
+		}
+		mutex->waiters--;
+		if (!mutex->waiters)
+		{
+			do
+			{
+				state = mutex->state;
+			} while (!state_update ( mutex, state, state & ~MUTEX_WAITING ));
+		}
+		if (!woken)
+		{
+			timeout = 0;
+		}
+		else if (RTOS_WAIT_FOREVER != timeout)
+		{
+			//another task took it first, wait for the time left
+			rtos_tick_t now = rtos_get_clock ();
+			timeout = deadline > now ? deadline - now : 0;
+		}
+	}
+	rtos_kernel_exit_critical ( critical );
+	__DMB ();
+	return 1;
+}
+
+uint8_t rtos_mutex_unlock ( rtos_mutex_t *mutex )
+{
+	uint32_t owner = caller_owner ();
+	uint8_t woken = 0;
+	rtos_critical_t critical;
+	uint32_t state;
+	__DMB ();
+	do
+	{
+		state = __LDREXW ( &mutex->state );
+		if (( state & MUTEX_OWNER_MASK ) != owner)
+		{
+			__CLREX ();
+			return 0;
+		}
+		if (state & MUTEX_WAITING)
+		{
+			__CLREX ();
+			break;
+		}
+	} while (__STREXW ( 0, &mutex->state ));
+	if (!( state & MUTEX_WAITING ))
+	{
+		return 1;
+	}
+	critical = rtos_kernel_enter_critical ();
+	//the flag only changes in the critical section, a plain store is enough
+	mutex->state = MUTEX_WAITING;
+	woken = rtos_kernel_wake ( mutex, 0 );
+	rtos_kernel_exit_critical ( critical );
+	if (woken)
+	{
+		rtos_kernel_yield ();
+	}
+	return 1;
+}
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+static inline uint32_t caller_owner ( void )
+{
+	rtos_task_handle_t task = rtos_kernel_current_task ();
+	//0 marks a free mutex, the tasks are their slot plus one
+	return 0 > task ? MUTEX_NO_TASK : ( uint32_t ) task + 1;
+}
+
+static uint8_t state_update ( rtos_mutex_t *mutex, uint32_t expected,
+		uint32_t value )
+{
+	do
+	{
+		if (__LDREXW ( &mutex->state ) != expected)
+		{
+			__CLREX ();
+			return 0;
+		}
+	} while (__STREXW ( value, &mutex->state ));
+	return 1;
+}
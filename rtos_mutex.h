@@ -0,0 +1,55 @@
+/**
+ * @file rtos_mutex.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos mutex API
+ *
+ * Non recursive mutex for tasks. Taking a free mutex and releasing one
+ * nobody waits for is one LDREX/STREX on its state word, the kernel is
+ * only entered on contention. A task waiting for it is blocked, so it
+ * can not be used from ISRs.
+ */
+
+#ifndef SOURCE_RTOS_MUTEX_H_
+#define SOURCE_RTOS_MUTEX_H_
+
+#include "rtos.h"
+
+/*! @brief Initializer of a free mutex */
+#define RTOS_MUTEX_INITIALIZER	{ 0, 0 }
+
+/*! @brief Mutex type, its fields are private to the mutex module */
+typedef struct
+{
+	volatile uint32_t state;	//TCB slot of the owner plus 1, 0 while free, and the waiting flag
+	uint32_t waiters;
+} rtos_mutex_t;
+
+/*!
+ * @brief Initializes a free mutex
+ *
+ * @param mutex mutex to initialize
+ * @retval none
+ */
+void rtos_mutex_init ( rtos_mutex_t *mutex );
+
+/*!
+ * @brief Takes the mutex, waiting while another task owns it
+ *
+ * @param mutex mutex to take
+ * @param timeout ticks to wait, 0 to return at once, or RTOS_WAIT_FOREVER
+ * @retval 1 if taken, 0 on timeout
+ */
+uint8_t rtos_mutex_lock ( rtos_mutex_t *mutex, rtos_tick_t timeout );
+
+/*!
+ * @brief Releases the mutex taken by the calling task, the highest
+ * priority task waiting for it gets a chance to take it. A mutex held
+ * by another task is left as it is
+ *
+ * @param mutex mutex to release
+ * @retval 1 if released, 0 if the calling task does not own it
+ */
+uint8_t rtos_mutex_unlock ( rtos_mutex_t *mutex );
+
+#endif /* SOURCE_RTOS_MUTEX_H_ */
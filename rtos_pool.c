@@ -0,0 +1,163 @@
+/**
+ * @file rtos_pool.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of rtos fixed-block memory pools
+ *
+ * The free list is a LIFO updated with LDREX/STREX. Any exception
+ * between the load and the store clears the exclusive monitor, so
+ * the store fails and the operation is retried; this also rules out
+ * the ABA problem of compare-and-swap lists.
+ */
+
+#include "rtos_pool.h"
+#include "rtos_kernel.h"
+
+/**********************************************************************************/
+// Local methods prototypes
+/**********************************************************************************/
+
+static void *
+pool_take ( rtos_pool_t *pool );
+static uint32_t
+atomic_add ( volatile uint32_t *value, int32_t delta );
+static void
+atomic_max ( volatile uint32_t *value, uint32_t candidate );
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+void *rtos_pool_alloc ( rtos_pool_t *pool, rtos_tick_t timeout )
+{
+	void *block = pool_take ( pool );
+	rtos_tick_t deadline = rtos_get_clock () + timeout;
+	if (__get_IPSR ())
+	{
+		timeout = 0;
+	}
+	while (!block && timeout)
+	{
+		rtos_critical_t critical = rtos_kernel_enter_critical ();
+		uint8_t woken;
+		//counted as a waiter before looking again, so a free on another core that still
+		//finds the pool empty here sees the count and wakes us
+		atomic_add ( &pool->waiters, 1 );
+		__DMB ();
+		block = pool_take ( pool );
+		if (block)
+		{
+			atomic_add ( &pool->waiters, -1 );
+			rtos_kernel_exit_critical ( critical );
+			break;
+		}
+		woken = rtos_kernel_block ( pool, timeout, critical );
+		atomic_add ( &pool->waiters, -1 );
+		block = pool_take ( pool );
+		if (!woken)
+		{
+			timeout = 0;
+		}
+		else if (RTOS_WAIT_FOREVER != timeout)
+		{
+			//another task got the block first, wait for the time left
+			rtos_tick_t now = rtos_get_clock ();
+			timeout = deadline > now ? deadline - now : 0;
+		}
+	}
+	return block;
+}
+
+void rtos_pool_free ( rtos_pool_t *pool, void *block )
+{
+	void *head;
+	do
+	{
+		head = ( void * ) __LDREXW ( ( volatile uint32_t * ) &pool->free_list );
+		*( void ** ) block = head;
+	} while (__STREXW ( ( uint32_t ) block,
+			( volatile uint32_t * ) &pool->free_list ));
+	atomic_add ( &pool->used, -1 );
+	//the block is in the list before the waiters are read, paired with the barrier in alloc
+	__DMB ();
+	if (pool->waiters)
+	{
+		rtos_critical_t critical = rtos_kernel_enter_critical ();
+		rtos_kernel_wake ( pool, 0 );
+		rtos_kernel_exit_critical ( critical );
+		rtos_kernel_yield ();
+	}
+}
+
+uint32_t rtos_pool_get_used ( rtos_pool_t *pool )
+{
+	return pool->used;
+}
+
+uint32_t rtos_pool_get_high_water ( rtos_pool_t *pool )
+{
+	return pool->high_water;
+}
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+//Pops a released block, or hands out a block never used before
+static void *pool_take ( rtos_pool_t *pool )
+{
+	void *block;
+	do
+	{
+		block = ( void * ) __LDREXW ( ( volatile uint32_t * ) &pool->free_list );
+		if (!block)
+		{
+			break;
+		}
+	} while (__STREXW ( ( uint32_t ) * ( void ** ) block,
+			( volatile uint32_t * ) &pool->free_list ));
+	if (!block)
+	{
+		uint32_t untouched;
+		do
+		{
+			untouched = __LDREXW ( &pool->untouched );
+			if (pool->blocks == untouched)
+			{
+				break;
+			}
+		} while (__STREXW ( untouched + 1, &pool->untouched ));
+		if (pool->blocks == untouched)
+		{
+			__CLREX ();
+			return 0;
+		}
+		block = &pool->storage [ untouched * pool->block_words ];
+	}
+	atomic_max ( &pool->high_water, atomic_add ( &pool->used, 1 ) );
+	return block;
+}
+
+static uint32_t atomic_add ( volatile uint32_t *value, int32_t delta )
+{
+	uint32_t current;
+	do
+	{
+		current = __LDREXW ( value ) + delta;
+	} while (__STREXW ( current, value ));
+	return current;
+}
+
+static void atomic_max ( volatile uint32_t *value, uint32_t candidate )
+{
+	uint32_t current;
+	do
+	{
+		current = __LDREXW ( value );
+		if (current >= candidate)
+		{
+			__CLREX ();
+			return;
+		}
+	} while (__STREXW ( candidate, value ));
+}
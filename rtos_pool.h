@@ -0,0 +1,87 @@
+/**
+ * @file rtos_pool.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos fixed-block memory pools API
+ *
+ * Statically declared pools of equally sized blocks. Allocation and
+ * release are O(1) and lock free, so both can be used from ISRs;
+ * tasks may also block on an empty pool with a timeout.
+ */
+
+#ifndef SOURCE_RTOS_POOL_H_
+#define SOURCE_RTOS_POOL_H_
+
+#include "rtos.h"
+
+/*! @brief Words taken by each block of a given size in bytes */
+#define RTOS_POOL_BLOCK_WORDS(size)	\
+	(((size) + sizeof(uint32_t) - 1) / sizeof(uint32_t))
+
+/*! @brief Alignment in bytes of the storage of the pools */
+#define RTOS_POOL_ALIGNMENT			8
+
+/*!
+ * @brief Declares a pool and its storage, no initialization is needed.
+ * The first block is aligned to RTOS_POOL_ALIGNMENT, the next ones too
+ * when the size is a multiple of it
+ *
+ * @param name name of the rtos_pool_t variable
+ * @param size size in bytes of each block
+ * @param count number of blocks
+ */
+#define RTOS_POOL_DEFINE(name, size, count)									\
+	static uint32_t name##_storage [ RTOS_POOL_BLOCK_WORDS(size) * (count) ]	\
+			__attribute__((aligned(RTOS_POOL_ALIGNMENT)));						\
+	rtos_pool_t name =														\
+	{ 0, 0, name##_storage, RTOS_POOL_BLOCK_WORDS(size), (count), 0, 0, 0 }
+
+/*! @brief Memory pool type, its fields are private to the pool module */
+typedef struct
+{
+	void *volatile free_list;	//released blocks, linked through their first word
+	volatile uint32_t untouched;	//blocks handed out at least once, from the start
+	uint32_t *storage;
+	uint32_t block_words;
+	uint32_t blocks;
+	volatile uint32_t used;
+	volatile uint32_t high_water;
+	volatile uint32_t waiters;
+} rtos_pool_t;
+
+/*!
+ * @brief Takes a block from the pool. From ISRs the timeout must be 0
+ *
+ * @param pool pool to take the block from
+ * @param timeout ticks to wait for a free block, 0 to return at once,
+ * or RTOS_WAIT_FOREVER
+ * @retval the block, 0 if none got free before the timeout
+ */
+void *rtos_pool_alloc ( rtos_pool_t *pool, rtos_tick_t timeout );
+
+/*!
+ * @brief Gives a block back to its pool, it can be called from ISRs
+ *
+ * @param pool pool the block was taken from
+ * @param block block to release
+ * @retval none
+ */
+void rtos_pool_free ( rtos_pool_t *pool, void *block );
+
+/*!
+ * @brief Returns the number of blocks currently in use
+ *
+ * @param pool pool to check
+ * @retval blocks in use
+ */
+uint32_t rtos_pool_get_used ( rtos_pool_t *pool );
+
+/*!
+ * @brief Returns the highest number of blocks ever in use at once
+ *
+ * @param pool pool to check
+ * @retval high-water mark in blocks
+ */
+uint32_t rtos_pool_get_high_water ( rtos_pool_t *pool );
+
+#endif /* SOURCE_RTOS_POOL_H_ */
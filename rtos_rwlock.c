@@ -0,0 +1,274 @@
+/**
+ * @file rtos_rwlock.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of rtos readers-writer lock
+ *
+ * The state word holds the count of readers and three flags. The fast
+ * paths only succeed when no flag asks for the kernel: readers while no
+ * writer holds or waits for the lock, writers on a free lock, and the
+ * releases with nobody waiting. The slow paths run in the kernel critical
+ * section, which keeps the waiting counts and their flags in step, and
+ * still update the state with LDREX/STREX as the fast paths run outside
+ * it. Readers wait on readers_waiting and writers on writers_waiting.
+ */
+
+#include "rtos_rwlock.h"
+#include "rtos_kernel.h"
+
+/**********************************************************************************/
+// Module defines
+/**********************************************************************************/
+
+#define RWLOCK_WRITER				0x80000000u	//held by a writer
+#define RWLOCK_WRITERS_WAITING		0x40000000u
+#define RWLOCK_READERS_WAITING		0x20000000u
+#define RWLOCK_READERS_MASK			0x1FFFFFFFu
+
+/**********************************************************************************/
+// Local methods prototypes
+/**********************************************************************************/
+
+static uint8_t
+state_update ( rtos_rwlock_t *lock, uint32_t expected, uint32_t value );
+static void
+state_set ( rtos_rwlock_t *lock, uint32_t set, uint32_t clear );
+static uint8_t
+lock_wait ( rtos_rwlock_t *lock, uint8_t writer, rtos_tick_t *timeout,
+		rtos_tick_t deadline, rtos_critical_t critical );
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+void rtos_rwlock_init ( rtos_rwlock_t *lock )
+{
+	lock->state = 0;
+	lock->readers_waiting = 0;
+	lock->writers_waiting = 0;
+}
+
+uint8_t rtos_rwlock_read_lock ( rtos_rwlock_t *lock, rtos_tick_t timeout )
+{
+	rtos_tick_t deadline;
+	rtos_critical_t critical;
+	uint32_t state;
+	do
+	{
+		state = __LDREXW ( &lock->state );
+		if (state & ( RWLOCK_WRITER | RWLOCK_WRITERS_WAITING ))
+		{
+			__CLREX ();
+			break;
+		}
+	} while (__STREXW ( state + 1, &lock->state ));
+	if (!( state & ( RWLOCK_WRITER | RWLOCK_WRITERS_WAITING ) ))
+	{
+		__DMB ();
+		return 1;
+	}
+	deadline = rtos_get_clock () + timeout;
+	critical = rtos_kernel_enter_critical ();
+	for ( ;; )
+	{
+		state = lock->state;
+		if (!( state & ( RWLOCK_WRITER | RWLOCK_WRITERS_WAITING ) ))
+		{
+			if (state_update ( lock, state, state + 1 ))
+			{
+				break;
+			}
+			continue;
+		}
+		if (!lock_wait ( lock, 0, &timeout, deadline, critical ))
+		{
+			return 0;
+		}
+		critical = rtos_kernel_enter_critical ();
+	}
+	rtos_kernel_exit_critical ( critical );
+	__DMB ();
+	return 1;
+}
+
+void rtos_rwlock_read_unlock ( rtos_rwlock_t *lock )
+{
+	rtos_critical_t critical;
+	uint8_t woken = 0;
+	uint32_t state;
+	__DMB ();
+	do
+	{
+		state = __LDREXW ( &lock->state );
+		if (state & RWLOCK_WRITERS_WAITING)
+		{
+			__CLREX ();
+			break;
+		}
+	} while (__STREXW ( state - 1, &lock->state ));
+	if (!( state & RWLOCK_WRITERS_WAITING ))
+	{
+		return;
+	}
+	//the last reader lets the writer in
+	critical = rtos_kernel_enter_critical ();
+	do
+	{
+		state = lock->state;
+	} while (!state_update ( lock, state, state - 1 ));
+	if (!( ( state - 1 ) & RWLOCK_READERS_MASK ) && lock->writers_waiting)
+	{
+		woken = rtos_kernel_wake ( &lock->writers_waiting, 0 );
+	}
+	rtos_kernel_exit_critical ( critical );
+	if (woken)
+	{
+		rtos_kernel_yield ();
+	}
+}
+
+uint8_t rtos_rwlock_write_lock ( rtos_rwlock_t *lock, rtos_tick_t timeout )
+{
+	rtos_tick_t deadline;
+	rtos_critical_t critical;
+	if (state_update ( lock, 0, RWLOCK_WRITER ))
+	{
+		__DMB ();
+		return 1;
+	}
+	deadline = rtos_get_clock () + timeout;
+	critical = rtos_kernel_enter_critical ();
+	for ( ;; )
+	{
+		uint32_t state = lock->state;
+		if (!( state & ( RWLOCK_WRITER | RWLOCK_READERS_MASK ) ))
+		{
+			if (state_update ( lock, state, state | RWLOCK_WRITER ))
+			{
+				break;
+			}
+			continue;
+		}
+		if (!lock_wait ( lock, 1, &timeout, deadline, critical ))
+		{
+			return 0;
+		}
+		critical = rtos_kernel_enter_critical ();
+	}
+	rtos_kernel_exit_critical ( critical );
+	__DMB ();
+	return 1;
+}
+
+void rtos_rwlock_write_unlock ( rtos_rwlock_t *lock )
+{
+	rtos_critical_t critical;
+	uint8_t woken = 0;
+	__DMB ();
+	if (state_update ( lock, RWLOCK_WRITER, 0 ))
+	{
+		return;
+	}
+	critical = rtos_kernel_enter_critical ();
+	state_set ( lock, 0, RWLOCK_WRITER );
+	if (lock->writers_waiting)
+	{
+		woken = rtos_kernel_wake ( &lock->writers_waiting, 0 );
+	}
+	else if (lock->readers_waiting)
+	{
+		woken = rtos_kernel_wake ( &lock->readers_waiting, 1 );
+	}
+	rtos_kernel_exit_critical ( critical );
+	if (woken)
+	{
+		rtos_kernel_yield ();
+	}
+}
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+static uint8_t state_update ( rtos_rwlock_t *lock, uint32_t expected,
+		uint32_t value )
+{
+	do
+	{
+		if (__LDREXW ( &lock->state ) != expected)
+		{
+			__CLREX ();
+			return 0;
+		}
+	} while (__STREXW ( value, &lock->state ));
+	return 1;
+}
+
+//Changes flags and sets the waiting ones from the counts, inside the critical section
+static void state_set ( rtos_rwlock_t *lock, uint32_t set, uint32_t clear )
+{
+	uint32_t state;
+	uint32_t value;
+	do
+	{
+		state = lock->state;
+		value = ( state | set ) & ~clear
+				& ~( RWLOCK_WRITERS_WAITING | RWLOCK_READERS_WAITING );
+		if (lock->writers_waiting)
+		{
+			value |= RWLOCK_WRITERS_WAITING;
+		}
+		if (lock->readers_waiting)
+		{
+			value |= RWLOCK_READERS_WAITING;
+		}
+	} while (!state_update ( lock, state, value ));
+}
+
+//Blocks inside the critical section of the caller and leaves it, 0 once the time is over.
+//A writer giving up lets the readers queued behind it in.
+static uint8_t lock_wait ( rtos_rwlock_t *lock, uint8_t writer,
+		rtos_tick_t *timeout, rtos_tick_t deadline, rtos_critical_t critical )
+{
+	uint8_t *waiting = writer ? &lock->writers_waiting : &lock->readers_waiting;
+	uint32_t busy =
+			writer ? RWLOCK_WRITER | RWLOCK_READERS_MASK :
+					RWLOCK_WRITER | RWLOCK_WRITERS_WAITING;
+	uint8_t woken = 1;
+	uint8_t readers_woken = 0;
+	if (!*timeout)
+	{
+		rtos_kernel_exit_critical ( critical );
+		return 0;
+	}
+	( *waiting )++;
+	state_set ( lock, 0, 0 );
+	//a release on another core may have missed the flag, it is checked again once set
+	if (lock->state & busy)
+	{
+		woken = rtos_kernel_block ( waiting, *timeout, critical );
+		critical = rtos_kernel_enter_critical ();
+	}
+	( *waiting )--;
+	state_set ( lock, 0, 0 );
+	if (!woken)
+	{
+		*timeout = 0;
+	}
+	else if (RTOS_WAIT_FOREVER != *timeout)
+	{
+		rtos_tick_t now = rtos_get_clock ();
+		*timeout = deadline > now ? deadline - now : 0;
+	}
+	if (writer && !lock->writers_waiting && lock->readers_waiting
+			&& !( lock->state & RWLOCK_WRITER ))
+	{
+		readers_woken = rtos_kernel_wake ( &lock->readers_waiting, 1 );
+	}
+	rtos_kernel_exit_critical ( critical );
+	if (readers_woken)
+	{
+		rtos_kernel_yield ();
+	}
+	return 1;
+}
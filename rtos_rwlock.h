@@ -0,0 +1,78 @@
+/**
+ * @file rtos_rwlock.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos readers-writer lock API
+ *
+ * Any number of tasks hold the lock to read, or a single task holds it
+ * to write. Taking and releasing it without contention is one LDREX/STREX
+ * on the state word, without entering the kernel; the kernel is only
+ * entered to wait or to wake waiters. Writers are preferred: once a
+ * writer waits, new readers wait behind it. The highest priority writer
+ * waiting is woken first, and the readers only when no writer waits.
+ *
+ * A task waiting for it is blocked, so it can not be used from ISRs.
+ */
+
+#ifndef SOURCE_RTOS_RWLOCK_H_
+#define SOURCE_RTOS_RWLOCK_H_
+
+#include "rtos.h"
+
+/*! @brief Initializer of a free readers-writer lock */
+#define RTOS_RWLOCK_INITIALIZER	{ 0, 0, 0 }
+
+/*! @brief Readers-writer lock type, its fields are private to the module */
+typedef struct
+{
+	volatile uint32_t state;	//readers holding it, and the writer and waiting flags
+	uint8_t readers_waiting;
+	uint8_t writers_waiting;
+} rtos_rwlock_t;
+
+/*!
+ * @brief Initializes a free readers-writer lock
+ *
+ * @param lock lock to initialize
+ * @retval none
+ */
+void rtos_rwlock_init ( rtos_rwlock_t *lock );
+
+/*!
+ * @brief Takes the lock to read, waiting while a writer holds it or
+ * waits for it
+ *
+ * @param lock lock to take
+ * @param timeout ticks to wait, 0 to return at once, or RTOS_WAIT_FOREVER
+ * @retval 1 if taken, 0 on timeout
+ */
+uint8_t rtos_rwlock_read_lock ( rtos_rwlock_t *lock, rtos_tick_t timeout );
+
+/*!
+ * @brief Releases the lock taken to read, the last reader lets a
+ * waiting writer in
+ *
+ * @param lock lock to release
+ * @retval none
+ */
+void rtos_rwlock_read_unlock ( rtos_rwlock_t *lock );
+
+/*!
+ * @brief Takes the lock to write, waiting while it is held
+ *
+ * @param lock lock to take
+ * @param timeout ticks to wait, 0 to return at once, or RTOS_WAIT_FOREVER
+ * @retval 1 if taken, 0 on timeout
+ */
+uint8_t rtos_rwlock_write_lock ( rtos_rwlock_t *lock, rtos_tick_t timeout );
+
+/*!
+ * @brief Releases the lock taken to write, a waiting writer gets a
+ * chance to take it, else all the waiting readers do
+ *
+ * @param lock lock to release
+ * @retval none
+ */
+void rtos_rwlock_write_unlock ( rtos_rwlock_t *lock );
+
+#endif /* SOURCE_RTOS_RWLOCK_H_ */
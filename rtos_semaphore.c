@@ -0,0 +1,177 @@
+/**
+ * @file rtos_semaphore.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of rtos counting semaphore
+ *
+ * The state word holds the count and a flag set while tasks wait, laid
+ * out like the mutex one. Takes with a count left and gives without the
+ * flag are done with LDREX/STREX in the caller; the rest runs in the
+ * kernel critical section, which keeps the flag in step with the count
+ * of waiters.
+ */
+
+#include "rtos_semaphore.h"
+#include "rtos_kernel.h"
+
+/**********************************************************************************/
+// Module defines
+/**********************************************************************************/
+
+#define SEMAPHORE_WAITING			0x80000000u
+#define SEMAPHORE_COUNT_MASK		0x7FFFFFFFu
+
+/**********************************************************************************/
+// Local methods prototypes
+/**********************************************************************************/
+
+static uint8_t
+state_update ( rtos_semaphore_t *semaphore, uint32_t expected, uint32_t value );
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+void rtos_semaphore_init ( rtos_semaphore_t *semaphore, uint32_t count,
+		uint32_t limit )
+{
+	semaphore->limit = limit & SEMAPHORE_COUNT_MASK;
+	semaphore->state = count < semaphore->limit ? count : semaphore->limit;
+	semaphore->waiters = 0;
+}
+
+uint8_t rtos_semaphore_take ( rtos_semaphore_t *semaphore, rtos_tick_t timeout )
+{
+	rtos_tick_t deadline;
+	rtos_critical_t critical;
+	uint32_t state;
+	do
+	{
+		state = __LDREXW ( &semaphore->state );
+		if (!( state & SEMAPHORE_COUNT_MASK ))
+		{
+			__CLREX ();
+			break;
+		}
+	} while (__STREXW ( state - 1, &semaphore->state ));
+	if (state & SEMAPHORE_COUNT_MASK)
+	{
+		__DMB ();
+		return 1;
+	}
+	if (__get_IPSR ())
+	{
+		return 0;
+	}
+	deadline = rtos_get_clock () + timeout;
+	critical = rtos_kernel_enter_critical ();
+	for ( ;; )
+	{
+		uint8_t woken = 1;
+		state = semaphore->state;
+		if (state & SEMAPHORE_COUNT_MASK)
+		{
+			if (state_update ( semaphore, state, state - 1 ))
+			{
+				break;
+			}
+			continue;
+		}
+		if (!timeout)
+		{
+			rtos_kernel_exit_critical ( critical );
+			return 0;
+		}
+		semaphore->waiters++;
+		if (state_update ( semaphore, state, state | SEMAPHORE_WAITING ))
+		{
+			//the next give goes through the slow path, which wakes us
+			woken = rtos_kernel_block ( semaphore, timeout, critical );
+			critical = rtos_kernel_enter_critical ();
+		}
+		semaphore->waiters--;
+		if (!semaphore->waiters)
+		{
+			do
+			{
+				state = semaphore->state;
+			} while (!state_update ( semaphore, state,
+					state & ~SEMAPHORE_WAITING ));
+		}
+		if (!woken)
+		{
+			timeout = 0;
+		}
+		else if (RTOS_WAIT_FOREVER != timeout)
+		{
+			//another task took it first, wait for the time left
+			rtos_tick_t now = rtos_get_clock ();
+			timeout = deadline > now ? deadline - now : 0;
+		}
+	}
+	rtos_kernel_exit_critical ( critical );
+	__DMB ();
+	return 1;
+}
+
+uint8_t rtos_semaphore_give ( rtos_semaphore_t *semaphore )
+{
+	rtos_critical_t critical;
+	uint8_t woken;
+	uint32_t state;
+	__DMB ();
+	do
+	{
+		state = __LDREXW ( &semaphore->state );
+		if (( state & SEMAPHORE_WAITING )
+				|| ( state & SEMAPHORE_COUNT_MASK ) >= semaphore->limit)
+		{
+			__CLREX ();
+			break;
+		}
+	} while (__STREXW ( state + 1, &semaphore->state ));
+	if (!( state & SEMAPHORE_WAITING ))
+	{
+		return ( state & SEMAPHORE_COUNT_MASK ) < semaphore->limit;
+	}
+	critical = rtos_kernel_enter_critical ();
+	do
+	{
+		state = semaphore->state;
+		if (( state & SEMAPHORE_COUNT_MASK ) >= semaphore->limit)
+		{
+			rtos_kernel_exit_critical ( critical );
+			return 0;
+		}
+	} while (!state_update ( semaphore, state, state + 1 ));
+	woken = rtos_kernel_wake ( semaphore, 0 );
+	rtos_kernel_exit_critical ( critical );
+	if (woken)
+	{
+		rtos_kernel_yield ();
+	}
+	return 1;
+}
+
+uint32_t rtos_semaphore_get_count ( rtos_semaphore_t *semaphore )
+{
+	return semaphore->state & SEMAPHORE_COUNT_MASK;
+}
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+static uint8_t state_update ( rtos_semaphore_t *semaphore, uint32_t expected,
+		uint32_t value )
+{
+	do
+	{
+		if (__LDREXW ( &semaphore->state ) != expected)
+		{
+			__CLREX ();
+			return 0;
+		}
+	} while (__STREXW ( value, &semaphore->state ));
+	return 1;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file rtos_semaphore.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos counting semaphore API
+ *
+ * Taking a semaphore with a count left and giving one nobody waits for
+ * is one LDREX/STREX on its state word, the kernel is only entered to
+ * wait or to wake a waiter. The highest priority task waiting is woken
+ * first. Both can be used from ISRs, where a take never waits.
+ */
+
+#ifndef SOURCE_RTOS_SEMAPHORE_H_
+#define SOURCE_RTOS_SEMAPHORE_H_
+
+#include "rtos.h"
+
+/*!
+ * @brief Initializer of a semaphore
+ *
+ * @param count count it starts with
+ * @param limit highest count it reaches, 1 for a binary semaphore
+ */
+#define RTOS_SEMAPHORE_INITIALIZER(count, limit)	{ (count), (limit), 0 }
+
+/*! @brief Semaphore type, its fields are private to the semaphore module */
+typedef struct
+{
+	volatile uint32_t state;	//count and the waiting flag
+	uint32_t limit;
+	uint32_t waiters;
+} rtos_semaphore_t;
+
+/*!
+ * @brief Initializes a semaphore
+ *
+ * @param semaphore semaphore to initialize
+ * @param count count it starts with
+ * @param limit highest count it reaches, 1 for a binary semaphore
+ * @retval none
+ */
+void rtos_semaphore_init ( rtos_semaphore_t *semaphore, uint32_t count,
+		uint32_t limit );
+
+/*!
+ * @brief Takes one from the count, waiting while it is zero. From ISRs
+ * the timeout must be 0
+ *
+ * @param semaphore semaphore to take
+ * @param timeout ticks to wait, 0 to return at once, or RTOS_WAIT_FOREVER
+ * @retval 1 if taken, 0 on timeout
+ */
+uint8_t rtos_semaphore_take ( rtos_semaphore_t *semaphore, rtos_tick_t timeout );
+
+/*!
+ * @brief Adds one to the count, the highest priority task waiting gets
+ * a chance to take it. It can be called from ISRs
+ *
+ * @param semaphore semaphore to give
+ * @retval 1 if given, 0 if the count was at its limit
+ */
+uint8_t rtos_semaphore_give ( rtos_semaphore_t *semaphore );
+
+/*!
+ * @brief Returns the current count of a semaphore
+ *
+ * @param semaphore semaphore to check
+ * @retval count
+ */
+uint32_t rtos_semaphore_get_count ( rtos_semaphore_t *semaphore );
+
+#endif /* SOURCE_RTOS_SEMAPHORE_H_ */
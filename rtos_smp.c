@@ -0,0 +1,406 @@
+/**
+ * @file rtos_smp.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of rtos multi-core scheduling
+ *
+ * Each queue is a set of FIFO lists, one per priority, with a bitmap
+ * of the non empty ones, so the best task of a core is found with a
+ * single bit scan. A core only takes the lock of one queue at a time.
+ * The transitions of one task must not race each other, the kernel
+ * makes them under its lock.
+ */
+
+#include "rtos_smp.h"
+
+#if RTOS_NUMBER_OF_CORES > 1
+
+/**********************************************************************************/
+// Module defines
+/**********************************************************************************/
+
+#define INVALID_TASK				-1
+#define NO_CORE						0xFF
+#define CORE_BIT(core)				(( rtos_affinity_t ) 1 << (core))
+
+/**********************************************************************************/
+// Ready queues
+/**********************************************************************************/
+
+static struct
+{
+	struct
+	{
+		uint32_t bitmap;	//bit n set if the list of priority n is not empty
+		rtos_task_handle_t head [ RTOS_SMP_PRIORITIES ];
+		rtos_task_handle_t tail [ RTOS_SMP_PRIORITIES ];
+		volatile int16_t running_priority;	//threshold of the running task, -1 while idle, read unlocked as a hint
+	} cores [ RTOS_NUMBER_OF_CORES ];
+	struct
+	{
+		rtos_task_handle_t next;
+		rtos_task_handle_t prev;
+		uint8_t priority;
+		uint8_t threshold;	//priority a task must exceed to preempt this one
+		uint8_t level;	//list it is queued on, its threshold while preempted
+		uint8_t queue;	//core whose queue holds the task, NO_CORE if none
+		uint8_t running;	//core running the task, NO_CORE if none
+		uint8_t last_core;
+		rtos_affinity_t affinity;
+	} tasks [ RTOS_MAX_NUMBER_OF_TASKS + 1 ];
+} smp =
+{ .cores =
+{ [ 0 ... RTOS_NUMBER_OF_CORES - 1 ] =
+{ .running_priority = -1 } } };
+
+/**********************************************************************************/
+// Local methods prototypes
+/**********************************************************************************/
+
+static void
+enqueue ( uint8_t core, rtos_task_handle_t task, uint8_t at_head );
+static void
+dequeue ( rtos_task_handle_t task );
+static void
+place ( rtos_task_handle_t task );
+static uint8_t
+choose_core ( rtos_task_handle_t task );
+static rtos_task_handle_t
+steal ( uint8_t core, int16_t floor );
+
+static inline uint8_t highest_priority ( uint32_t bitmap )
+{
+	return 31 - __builtin_clz ( bitmap );
+}
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+void rtos_smp_add_task ( rtos_task_handle_t task, uint8_t priority )
+{
+	smp.tasks [ task ].priority =
+			priority < RTOS_SMP_PRIORITIES ?
+					priority : RTOS_SMP_PRIORITIES - 1;
+	smp.tasks [ task ].threshold = smp.tasks [ task ].priority;
+	smp.tasks [ task ].level = smp.tasks [ task ].priority;
+	smp.tasks [ task ].queue = NO_CORE;
+	smp.tasks [ task ].running = NO_CORE;
+	smp.tasks [ task ].last_core = 0;
+	smp.tasks [ task ].affinity = RTOS_AFFINITY_ALL;
+}
+
+void rtos_smp_set_affinity ( rtos_task_handle_t task,
+		rtos_affinity_t affinity )
+{
+	uint8_t queue = smp.tasks [ task ].queue;
+	uint8_t running = smp.tasks [ task ].running;
+	smp.tasks [ task ].affinity = affinity;
+	if (NO_CORE != queue && !( affinity & CORE_BIT(queue) ))
+	{
+		rtos_port_spin_lock ( queue );
+		dequeue ( task );
+		rtos_port_spin_unlock ( queue );
+		place ( task );
+	}
+	else if (NO_CORE != running && !( affinity & CORE_BIT(running) ))
+	{
+		rtos_port_send_ipi ( running );
+	}
+}
+
+void rtos_smp_set_threshold ( rtos_task_handle_t task, uint8_t threshold )
+{
+	smp.tasks [ task ].threshold =
+			threshold < smp.tasks [ task ].priority ?
+					smp.tasks [ task ].priority :
+			threshold < RTOS_SMP_PRIORITIES ?
+					threshold : RTOS_SMP_PRIORITIES - 1;
+}
+
+void rtos_smp_remove_task ( rtos_task_handle_t task )
+{
+	uint8_t queue = smp.tasks [ task ].queue;
+	uint8_t running = smp.tasks [ task ].running;
+	if (NO_CORE != queue)
+	{
+		rtos_port_spin_lock ( queue );
+		dequeue ( task );
+		rtos_port_spin_unlock ( queue );
+	}
+	else if (NO_CORE != running && running != rtos_port_core_id ())
+	{
+		rtos_port_send_ipi ( running );
+	}
+}
+
+void rtos_smp_ready ( rtos_task_handle_t task )
+{
+	if (NO_CORE != smp.tasks [ task ].queue
+			|| NO_CORE != smp.tasks [ task ].running)
+	{
+		return;
+	}
+	smp.tasks [ task ].level = smp.tasks [ task ].priority;
+	place ( task );
+}
+
+uint8_t rtos_smp_should_switch ( uint8_t core, rtos_task_handle_t running,
+		uint8_t runnable )
+{
+	uint32_t bitmap = smp.cores [ core ].bitmap;
+	if (INVALID_TASK == running || !runnable
+			|| !( smp.tasks [ running ].affinity & CORE_BIT(core) ))
+	{
+		return 1;
+	}
+	return bitmap
+			&& highest_priority ( bitmap ) > smp.tasks [ running ].threshold;
+}
+
+rtos_task_handle_t rtos_smp_pick ( uint8_t core, rtos_task_handle_t running,
+		uint8_t runnable )
+{
+	rtos_task_handle_t next = INVALID_TASK;
+	rtos_task_handle_t stolen;
+	int16_t floor = -1;
+	if (INVALID_TASK != running)
+	{
+		smp.tasks [ running ].running = NO_CORE;
+		if (runnable && !( smp.tasks [ running ].affinity & CORE_BIT(core) ))
+		{
+			smp.tasks [ running ].level = smp.tasks [ running ].threshold;
+			place ( running );
+			runnable = 0;
+		}
+	}
+	else
+	{
+		runnable = 0;
+	}
+	rtos_port_spin_lock ( core );
+	if (smp.cores [ core ].bitmap)
+	{
+		uint8_t priority = highest_priority ( smp.cores [ core ].bitmap );
+		if (!runnable || priority > smp.tasks [ running ].threshold)
+		{
+			next = smp.cores [ core ].head [ priority ];
+			dequeue ( next );
+			if (runnable)
+			{
+				//a preempted task waits at its threshold, first among it
+				smp.tasks [ running ].level = smp.tasks [ running ].threshold;
+				enqueue ( core, running, 1 );
+			}
+		}
+	}
+	if (INVALID_TASK == next && runnable)
+	{
+		next = running;
+		floor = smp.tasks [ running ].threshold;
+	}
+	else if (INVALID_TASK != next)
+	{
+		floor = smp.tasks [ next ].level;
+	}
+	rtos_port_spin_unlock ( core );
+	//the pinned idle task keeps every queue busy, so the other queues are
+	//looked at whenever they hold a task above the local choice
+	stolen = steal ( core, floor );
+	if (INVALID_TASK != stolen)
+	{
+		if (INVALID_TASK != next)
+		{
+			if (next == running)
+			{
+				smp.tasks [ running ].level = smp.tasks [ running ].threshold;
+			}
+			rtos_port_spin_lock ( core );
+			enqueue ( core, next, 1 );
+			rtos_port_spin_unlock ( core );
+		}
+		next = stolen;
+	}
+	if (INVALID_TASK != next)
+	{
+		smp.tasks [ next ].running = core;
+		smp.tasks [ next ].last_core = core;
+		smp.cores [ core ].running_priority = smp.tasks [ next ].threshold;
+	}
+	else
+	{
+		smp.cores [ core ].running_priority = -1;
+	}
+	return next;
+}
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+//Called with the lock of the queue taken
+static void enqueue ( uint8_t core, rtos_task_handle_t task, uint8_t at_head )
+{
+	uint8_t priority = smp.tasks [ task ].level;
+	if (!( smp.cores [ core ].bitmap & ( 1u << priority ) ))
+	{
+		smp.tasks [ task ].next = INVALID_TASK;
+		smp.tasks [ task ].prev = INVALID_TASK;
+		smp.cores [ core ].head [ priority ] = task;
+		smp.cores [ core ].tail [ priority ] = task;
+		smp.cores [ core ].bitmap |= 1u << priority;
+	}
+	else if (at_head)
+	{
+		smp.tasks [ task ].prev = INVALID_TASK;
+		smp.tasks [ task ].next = smp.cores [ core ].head [ priority ];
+		smp.tasks [ smp.cores [ core ].head [ priority ] ].prev = task;
+		smp.cores [ core ].head [ priority ] = task;
+	}
+	else
+	{
+		smp.tasks [ task ].next = INVALID_TASK;
+		smp.tasks [ task ].prev = smp.cores [ core ].tail [ priority ];
+		smp.tasks [ smp.cores [ core ].tail [ priority ] ].next = task;
+		smp.cores [ core ].tail [ priority ] = task;
+	}
+	smp.tasks [ task ].queue = core;
+}
+
+//Called with the lock of the queue holding the task taken
+static void dequeue ( rtos_task_handle_t task )
+{
+	uint8_t core = smp.tasks [ task ].queue;
+	uint8_t priority = smp.tasks [ task ].level;
+	rtos_task_handle_t next = smp.tasks [ task ].next;
+	rtos_task_handle_t prev = smp.tasks [ task ].prev;
+	if (INVALID_TASK != prev)
+	{
+		smp.tasks [ prev ].next = next;
+	}
+	else
+	{
+		smp.cores [ core ].head [ priority ] = next;
+	}
+	if (INVALID_TASK != next)
+	{
+		smp.tasks [ next ].prev = prev;
+	}
+	else
+	{
+		smp.cores [ core ].tail [ priority ] = prev;
+	}
+	if (INVALID_TASK == smp.cores [ core ].head [ priority ])
+	{
+		smp.cores [ core ].bitmap &= ~( 1u << priority );
+	}
+	smp.tasks [ task ].queue = NO_CORE;
+}
+
+//Queues a task on the core chosen for it, at its level, and interrupts that core if the
+//task should preempt there
+static void place ( rtos_task_handle_t task )
+{
+	uint8_t core = choose_core ( task );
+	rtos_port_spin_lock ( core );
+	enqueue ( core, task, 0 );
+	rtos_port_spin_unlock ( core );
+	if (smp.cores [ core ].running_priority < smp.tasks [ task ].level
+			&& core != rtos_port_core_id ())
+	{
+		rtos_port_send_ipi ( core );
+	}
+}
+
+//Last core if the task preempts there, else the first idle or lower priority
+//allowed core, else the last core (or the first allowed) where it will wait
+static uint8_t choose_core ( rtos_task_handle_t task )
+{
+	rtos_affinity_t affinity = smp.tasks [ task ].affinity;
+	uint8_t last = smp.tasks [ task ].last_core;
+	int16_t priority = smp.tasks [ task ].level;
+	uint8_t lowest = NO_CORE;
+	if (( affinity & CORE_BIT(last) )
+			&& smp.cores [ last ].running_priority < priority)
+	{
+		return last;
+	}
+	for ( uint8_t core = 0; core < RTOS_NUMBER_OF_CORES; core++ )
+	{
+		if (( affinity & CORE_BIT(core) )
+				&& smp.cores [ core ].running_priority < priority
+				&& ( NO_CORE == lowest
+						|| smp.cores [ core ].running_priority
+								< smp.cores [ lowest ].running_priority ))
+		{
+			lowest = core;
+		}
+	}
+	if (NO_CORE != lowest)
+	{
+		return lowest;
+	}
+	if (affinity & CORE_BIT(last))
+	{
+		return last;
+	}
+	for ( uint8_t core = 0; core < RTOS_NUMBER_OF_CORES; core++ )
+	{
+		if (affinity & CORE_BIT(core))
+		{
+			return core;
+		}
+	}
+	return last;
+}
+
+//Takes a task allowed on this core from the other queues, above the floor priority. The
+//queues are tried from the one with the highest priority, read unlocked as a hint; pinned
+//tasks, as the idle ones, are skipped
+static rtos_task_handle_t steal ( uint8_t core, int16_t floor )
+{
+	//the priorities up to the floor are masked out, all of them for a floor of 31
+	uint32_t above = floor < 0 ? ~0u : ~( ( 2u << floor ) - 1 );
+	rtos_affinity_t tried = CORE_BIT(core);
+	for ( ;; )
+	{
+		uint8_t victim = NO_CORE;
+		int16_t best = floor;
+		uint32_t bitmap;
+		for ( uint8_t other = 0; other < RTOS_NUMBER_OF_CORES; other++ )
+		{
+			bitmap = smp.cores [ other ].bitmap & above;
+			if (!( tried & CORE_BIT(other) ) && bitmap
+					&& highest_priority ( bitmap ) > best)
+			{
+				victim = other;
+				best = highest_priority ( bitmap );
+			}
+		}
+		if (NO_CORE == victim)
+		{
+			return INVALID_TASK;
+		}
+		tried |= CORE_BIT(victim);
+		rtos_port_spin_lock ( victim );
+		bitmap = smp.cores [ victim ].bitmap & above;
+		while (bitmap)
+		{
+			uint8_t priority = highest_priority ( bitmap );
+			for ( rtos_task_handle_t task = smp.cores [ victim ].head [ priority ];
+					INVALID_TASK != task; task = smp.tasks [ task ].next )
+			{
+				if (smp.tasks [ task ].affinity & CORE_BIT(core))
+				{
+					dequeue ( task );
+					rtos_port_spin_unlock ( victim );
+					return task;
+				}
+			}
+			bitmap &= ~( 1u << priority );
+		}
+		rtos_port_spin_unlock ( victim );
+	}
+}
+
+#endif
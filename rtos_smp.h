@@ -0,0 +1,139 @@
+/**
+ * @file rtos_smp.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos multi-core scheduling
+ *
+ * Per-core ready queues for the SMP mode (RTOS_NUMBER_OF_CORES > 1).
+ * Each core picks from its own queue and steals from the others when
+ * they hold a task above its own choice, which includes a core that
+ * would run its idle task. Tasks are placed on the core they
+ * last ran on when they may preempt there, else on an idle or lower
+ * priority core allowed by their affinity, which is interrupted.
+ *
+ * The kernel still calls in here under its one lock, so the context
+ * switches of all the cores are serialized on it: the scheduling is
+ * correct on several cores, but its throughput does not grow with them.
+ *
+ * This file has no hardware dependencies, the port provides the core
+ * id, the spinlocks and the inter-core interrupts.
+ */
+
+#ifndef SOURCE_RTOS_SMP_H_
+#define SOURCE_RTOS_SMP_H_
+
+#include "rtos.h"
+#include "rtos_config.h"
+
+/*! @brief Priority levels of the ready queues, higher ones are clamped */
+#define RTOS_SMP_PRIORITIES		32
+
+/*! @brief Spinlock of the kernel data, the ones below guard each queue */
+#define RTOS_SMP_KERNEL_LOCK	RTOS_NUMBER_OF_CORES
+
+/*!
+ * @brief Registers a task, not ready and allowed on every core
+ *
+ * @param task handle of the task
+ * @param priority number for the RMS algorithm
+ * @retval none
+ */
+void rtos_smp_add_task ( rtos_task_handle_t task, uint8_t priority );
+
+/*!
+ * @brief Changes the cores a task may run on. A queued task is moved,
+ * a running one is rescheduled by its core
+ *
+ * @param task handle of the task
+ * @param affinity bit n set allows the task on core n
+ * @retval none
+ */
+void rtos_smp_set_affinity ( rtos_task_handle_t task,
+		rtos_affinity_t affinity );
+
+/*!
+ * @brief Sets the priority a task must exceed to preempt the given one
+ * while it runs, it is clamped between its priority and the last queue
+ *
+ * @param task handle of the task
+ * @param threshold preemption threshold
+ * @retval none
+ */
+void rtos_smp_set_threshold ( rtos_task_handle_t task, uint8_t threshold );
+
+/*!
+ * @brief Takes a deleted task out of its ready queue. A task running on
+ * another core is rescheduled by its core
+ *
+ * @param task handle of the task
+ * @retval none
+ */
+void rtos_smp_remove_task ( rtos_task_handle_t task );
+
+/*!
+ * @brief Queues a task that became ready and interrupts the core chosen
+ * for it if it should preempt there. A task already queued or running
+ * is left as is
+ *
+ * @param task handle of the task
+ * @retval none
+ */
+void rtos_smp_ready ( rtos_task_handle_t task );
+
+/*!
+ * @brief Tells if the core should switch away from its running task
+ *
+ * @param core core asking
+ * @param running task running on the core, -1 if none
+ * @param runnable 0 if the running task can not go on
+ * @retval 1 if the core should call rtos_smp_pick
+ */
+uint8_t rtos_smp_should_switch ( uint8_t core, rtos_task_handle_t running,
+		uint8_t runnable );
+
+/*!
+ * @brief Chooses the next task for a core. A runnable task that loses
+ * the core goes back to the head of its queue. A ready task of another
+ * queue, allowed on the core and above the local choice, is stolen
+ *
+ * @param core core asking
+ * @param running task running on the core, -1 if none
+ * @param runnable 0 if the running task can not go on
+ * @retval task to run, -1 if there is none
+ */
+rtos_task_handle_t rtos_smp_pick ( uint8_t core, rtos_task_handle_t running,
+		uint8_t runnable );
+
+/*!
+ * @brief Port: returns the core running the caller
+ *
+ * @param none
+ * @retval core number, from 0 to RTOS_NUMBER_OF_CORES - 1
+ */
+uint8_t rtos_port_core_id ( void );
+
+/*!
+ * @brief Port: interrupts a core so it calls the dispatcher
+ *
+ * @param core core to interrupt
+ * @retval none
+ */
+void rtos_port_send_ipi ( uint8_t core );
+
+/*!
+ * @brief Port: takes an inter-core spinlock, interrupts are already masked
+ *
+ * @param lock from 0 to RTOS_SMP_KERNEL_LOCK
+ * @retval none
+ */
+void rtos_port_spin_lock ( uint8_t lock );
+
+/*!
+ * @brief Port: releases an inter-core spinlock
+ *
+ * @param lock from 0 to RTOS_SMP_KERNEL_LOCK
+ * @retval none
+ */
+void rtos_port_spin_unlock ( uint8_t lock );
+
+#endif /* SOURCE_RTOS_SMP_H_ */
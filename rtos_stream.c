@@ -0,0 +1,199 @@
+/**
+ * @file rtos_stream.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of rtos stream buffers
+ *
+ * With one writer and one reader, each side owns its index and the
+ * bytes between them, so the copies need no lock. The reader blocks on
+ * the stream and the writer on its buffer.
+ */
+
+#include "rtos_stream.h"
+#include "rtos_kernel.h"
+#include <string.h>
+
+/**********************************************************************************/
+// Local methods prototypes
+/**********************************************************************************/
+
+static uint8_t
+stream_wait ( void *object, rtos_tick_t *timeout, rtos_tick_t deadline,
+		rtos_critical_t critical );
+static inline uint32_t
+clamp_trigger ( rtos_stream_t *stream, uint32_t trigger );
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+void rtos_stream_init ( rtos_stream_t *stream, uint8_t *buffer, uint32_t size,
+		uint32_t trigger )
+{
+	stream->buffer = buffer;
+	stream->size = size;
+	stream->trigger = clamp_trigger ( stream, trigger );
+	stream->head = 0;
+	stream->tail = 0;
+	stream->count = 0;
+	stream->reader_wants = 0;
+	stream->writer_waits = 0;
+}
+
+uint32_t rtos_stream_send ( rtos_stream_t *stream, const void *data,
+		uint32_t length, rtos_tick_t timeout )
+{
+	rtos_tick_t deadline = rtos_get_clock () + timeout;
+	const uint8_t *bytes = data;
+	uint32_t sent = 0;
+	if (__get_IPSR ())
+	{
+		timeout = 0;
+	}
+	while (sent < length)
+	{
+		rtos_critical_t critical = rtos_kernel_enter_critical ();
+		uint32_t room = stream->size - stream->count;
+		uint32_t chunk;
+		uint8_t woken = 0;
+		if (!room)
+		{
+			stream->writer_waits = 1;
+			if (!stream_wait ( stream->buffer, &timeout, deadline, critical ))
+			{
+				break;
+			}
+			continue;
+		}
+		rtos_kernel_exit_critical ( critical );
+		chunk = length - sent < room ? length - sent : room;
+		//the room may wrap around the end of the buffer
+		room = stream->size - stream->tail;
+		if (chunk <= room)
+		{
+			memcpy ( &stream->buffer [ stream->tail ], &bytes [ sent ], chunk );
+		}
+		else
+		{
+			memcpy ( &stream->buffer [ stream->tail ], &bytes [ sent ], room );
+			memcpy ( stream->buffer, &bytes [ sent + room ], chunk - room );
+		}
+		stream->tail = ( stream->tail + chunk ) % stream->size;
+		sent += chunk;
+		critical = rtos_kernel_enter_critical ();
+		stream->count += chunk;
+		if (stream->reader_wants && stream->count >= stream->reader_wants)
+		{
+			stream->reader_wants = 0;
+			woken = rtos_kernel_wake ( stream, 0 );
+		}
+		rtos_kernel_exit_critical ( critical );
+		if (woken)
+		{
+			rtos_kernel_yield ();
+		}
+	}
+	return sent;
+}
+
+uint32_t rtos_stream_receive ( rtos_stream_t *stream, void *data,
+		uint32_t length, rtos_tick_t timeout )
+{
+	rtos_tick_t deadline = rtos_get_clock () + timeout;
+	uint32_t wanted = length < stream->trigger ? length : stream->trigger;
+	rtos_critical_t critical;
+	uint32_t chunk;
+	uint32_t room;
+	uint8_t woken = 0;
+	if (__get_IPSR ())
+	{
+		timeout = 0;
+	}
+	critical = rtos_kernel_enter_critical ();
+	while (stream->count < wanted)
+	{
+		stream->reader_wants = wanted;
+		if (!stream_wait ( stream, &timeout, deadline, critical ))
+		{
+			critical = rtos_kernel_enter_critical ();
+			stream->reader_wants = 0;
+			break;
+		}
+		critical = rtos_kernel_enter_critical ();
+	}
+	chunk = stream->count < length ? stream->count : length;
+	rtos_kernel_exit_critical ( critical );
+	if (!chunk)
+	{
+		return 0;
+	}
+	room = stream->size - stream->head;
+	if (chunk <= room)
+	{
+		memcpy ( data, &stream->buffer [ stream->head ], chunk );
+	}
+	else
+	{
+		memcpy ( data, &stream->buffer [ stream->head ], room );
+		memcpy ( ( uint8_t * ) data + room, stream->buffer, chunk - room );
+	}
+	stream->head = ( stream->head + chunk ) % stream->size;
+	critical = rtos_kernel_enter_critical ();
+	stream->count -= chunk;
+	if (stream->writer_waits)
+	{
+		stream->writer_waits = 0;
+		woken = rtos_kernel_wake ( stream->buffer, 0 );
+	}
+	rtos_kernel_exit_critical ( critical );
+	if (woken)
+	{
+		rtos_kernel_yield ();
+	}
+	return chunk;
+}
+
+void rtos_stream_set_trigger ( rtos_stream_t *stream, uint32_t trigger )
+{
+	stream->trigger = clamp_trigger ( stream, trigger );
+}
+
+uint32_t rtos_stream_get_available ( rtos_stream_t *stream )
+{
+	return stream->count;
+}
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+//Blocks inside the critical section of the caller and leaves it, 0 once the time is over
+static uint8_t stream_wait ( void *object, rtos_tick_t *timeout,
+		rtos_tick_t deadline, rtos_critical_t critical )
+{
+	if (!*timeout)
+	{
+		rtos_kernel_exit_critical ( critical );
+		return 0;
+	}
+	if (!rtos_kernel_block ( object, *timeout, critical ))
+	{
+		*timeout = 0;
+	}
+	else if (RTOS_WAIT_FOREVER != *timeout)
+	{
+		rtos_tick_t now = rtos_get_clock ();
+		*timeout = deadline > now ? deadline - now : 0;
+	}
+	return 1;
+}
+
+//A level above the size would never be reached, the reader would wait forever
+static inline uint32_t clamp_trigger ( rtos_stream_t *stream, uint32_t trigger )
+{
+	if (!trigger)
+	{
+		return 1;
+	}
+	return trigger < stream->size ? trigger : stream->size;
+}
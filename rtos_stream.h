@@ -0,0 +1,107 @@
+/**
+ * @file rtos_stream.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos stream buffers API
+ *
+ * Byte streams between one writer and one reader, a task or an ISR
+ * each, such as a UART ISR and its protocol parser. The writer copies
+ * whole blocks in; the reader blocks until the trigger level is reached,
+ * so it is woken once per message instead of once per byte or polling.
+ * The data is copied with memcpy outside the critical sections, only
+ * the byte count is updated inside them.
+ */
+
+#ifndef SOURCE_RTOS_STREAM_H_
+#define SOURCE_RTOS_STREAM_H_
+
+#include "rtos.h"
+
+/*!
+ * @brief Declares a stream buffer and its storage, no initialization is
+ * needed
+ *
+ * @param name name of the rtos_stream_t variable
+ * @param size size in bytes of the buffer
+ * @param trigger bytes that wake a waiting reader, 0 is taken as 1 and
+ * more than the size as the size
+ */
+#define RTOS_STREAM_DEFINE(name, size, trigger)							\
+	static uint8_t name##_storage [ (size) ];								\
+	rtos_stream_t name =													\
+	{ name##_storage, (size),												\
+	(trigger) > (size) ? (size) : (trigger) ? (trigger) : 1, 0, 0, 0, 0, 0 }
+
+/*! @brief Stream buffer type, its fields are private to the stream module */
+typedef struct
+{
+	uint8_t *buffer;
+	uint32_t size;
+	uint32_t trigger;
+	uint32_t head;	//next byte to read, only the reader moves it
+	uint32_t tail;	//next byte to write, only the writer moves it
+	volatile uint32_t count;
+	uint32_t reader_wants;	//bytes the waiting reader needs, 0 if none waits
+	uint8_t writer_waits;
+} rtos_stream_t;
+
+/*!
+ * @brief Sets up an empty stream buffer
+ *
+ * @param stream stream to set up
+ * @param buffer storage of the bytes
+ * @param size size in bytes of the storage
+ * @param trigger bytes that wake a waiting reader, 0 is taken as 1 and
+ * more than the size as the size
+ * @retval none
+ */
+void rtos_stream_init ( rtos_stream_t *stream, uint8_t *buffer, uint32_t size,
+		uint32_t trigger );
+
+/*!
+ * @brief Copies bytes into the stream, waiting for room as needed. From
+ * ISRs the timeout must be 0
+ *
+ * @param stream stream to write
+ * @param data bytes to write
+ * @param length number of bytes
+ * @param timeout ticks to wait for room, 0 to write what fits and return
+ * at once, or RTOS_WAIT_FOREVER
+ * @retval bytes written, less than length on timeout
+ */
+uint32_t rtos_stream_send ( rtos_stream_t *stream, const void *data,
+		uint32_t length, rtos_tick_t timeout );
+
+/*!
+ * @brief Copies bytes out of the stream once the trigger level, or
+ * length if smaller, is reached. From ISRs the timeout must be 0
+ *
+ * @param stream stream to read
+ * @param data where the bytes are copied
+ * @param length room in data
+ * @param timeout ticks to wait for the trigger level, 0 to return at
+ * once, or RTOS_WAIT_FOREVER
+ * @retval bytes read, on timeout the ones there were, maybe 0
+ */
+uint32_t rtos_stream_receive ( rtos_stream_t *stream, void *data,
+		uint32_t length, rtos_tick_t timeout );
+
+/*!
+ * @brief Changes the trigger level, a waiting reader keeps the old one
+ *
+ * @param stream stream to change
+ * @param trigger bytes that wake a waiting reader, 0 is taken as 1 and
+ * more than the size as the size
+ * @retval none
+ */
+void rtos_stream_set_trigger ( rtos_stream_t *stream, uint32_t trigger );
+
+/*!
+ * @brief Returns the number of bytes ready to be read
+ *
+ * @param stream stream to check
+ * @retval bytes in the stream
+ */
+uint32_t rtos_stream_get_available ( rtos_stream_t *stream );
+
+#endif /* SOURCE_RTOS_STREAM_H_ */
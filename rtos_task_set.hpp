@@ -0,0 +1,205 @@
+/**
+ * @file rtos_task_set.hpp
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos task set declared at compile time
+ *
+ * The tasks of the application are declared as one type, checked by
+ * the compiler and registered in priority order:
+ *
+ *	using Tasks = rtos::TaskSet<
+ *			rtos::TaskSpec<control_task, 3>,
+ *			rtos::TaskSpec<display_task, 1, 64>,
+ *			rtos::TaskSpec<logger_task, 2, 128, kStartSuspended>>;
+ *
+ *	Tasks::create ();
+ *	rtos_activate_task ( Tasks::handle<logger_task> () );
+ *	rtos_start_scheduler ();
+ *
+ * Each entry gets its own static stack of the size it declares, aligned
+ * for the MPU, so the set takes none of the RTOS_KERNEL_STACKS; those
+ * only have to cover kKernelTasks and the tasks created at runtime. The
+ * priority table is sorted at compile time, and as the set is the first
+ * thing created, the handle of each task is its place in the table, a
+ * compile time constant.
+ *
+ * The TCBs are not generated: they stay in the kernel task table, and
+ * create fills one per task at startup with rtos_create_static_task,
+ * which paints its stack. The dispatcher is the one of the kernel, it is
+ * not specialized for the set.
+ */
+
+#ifndef SOURCE_RTOS_TASK_SET_HPP_
+#define SOURCE_RTOS_TASK_SET_HPP_
+
+#include <array>
+
+extern "C"
+{
+#include "rtos.h"
+#include "rtos_config.h"
+}
+
+namespace rtos
+{
+
+/*! @brief Tasks the kernel creates itself on rtos_start_scheduler */
+constexpr uint8_t kKernelTasks = RTOS_NUMBER_OF_CORES
+#ifdef RTOS_ENABLE_SOFTWARE_TIMERS
+		+ 1
+#endif
+#ifdef RTOS_ENABLE_DEFERRED_ISR
+		+ 1
+#endif
+#ifdef RTOS_ENABLE_WORK_QUEUE
+		+ RTOS_WORK_QUEUE_WORKERS
+#endif
+		;
+
+/*! @brief Task of a TaskSet, the handle wrapper of rtos.hpp is rtos::Task */
+template<void (*Body) ( ), uint8_t Priority,
+		uint16_t StackWords = RTOS_STACK_SIZE,
+		rtos_autostart_e Autostart = kAutoStart>
+struct TaskSpec
+{
+	static_assert ( Body != nullptr, "a task needs a body" );
+	static_assert ( StackWords >= RTOS_STACK_MIN_WORDS,
+			"the stack can not hold the context of the task" );
+#ifdef RTOS_ENABLE_UNPRIVILEGED_TASKS
+	static_assert ( !( StackWords & ( StackWords - 1 ) ),
+			"the MPU region of the stack needs a power of two size" );
+#endif
+
+	static constexpr void (*body) ( ) = Body;
+	static constexpr uint8_t priority = Priority;
+	static constexpr uint16_t stack_words = StackWords;
+	static constexpr rtos_autostart_e autostart = Autostart;
+
+	/*! @brief Stack of the task, laid out as RTOS_STACK_DEFINE does */
+	struct Storage
+	{
+		uint32_t guard [ RTOS_STACK_GUARD_WORDS ];
+		alignas ( RTOS_STACK_ALIGNMENT(StackWords) ) uint32_t stack [ StackWords ];
+	};
+
+	static inline Storage storage;
+};
+
+/*! @brief Set of all the tasks of the application */
+template<typename ... Tasks>
+class TaskSet
+{
+public:
+	/*! @brief Number of tasks of the set */
+	static constexpr uint8_t count = sizeof...(Tasks);
+
+	static_assert ( count > 0, "a task set needs at least one task" );
+	static_assert ( RTOS_STACK_SIZE >= RTOS_STACK_MIN_WORDS,
+			"RTOS_STACK_SIZE can not hold the context of the kernel tasks" );
+	static_assert ( kKernelTasks <= RTOS_KERNEL_STACKS,
+			"RTOS_KERNEL_STACKS can not hold the kernel tasks" );
+	static_assert ( count + kKernelTasks <= RTOS_MAX_NUMBER_OF_TASKS,
+			"RTOS_MAX_NUMBER_OF_TASKS can not hold the task set" );
+
+	/*! @brief Entry of the task table */
+	struct Entry
+	{
+		void (*body) ( );
+		uint8_t priority;
+		rtos_autostart_e autostart;
+		uint32_t *stack;
+		uint16_t stack_words;
+	};
+
+	/*! @brief Task table sorted by priority, highest first, the declaration
+	 * order is kept among equal priorities */
+	static constexpr std::array<Entry, count> table = [] ()
+	{
+		std::array<Entry, count> table =
+		{ { { Tasks::body, Tasks::priority, Tasks::autostart,
+				Tasks::storage.stack, Tasks::stack_words } ... } };
+		for ( uint8_t sorted = 1; sorted < count; sorted++ )
+		{
+			Entry entry = table [ sorted ];
+			uint8_t index = sorted;
+			while (index && table [ index - 1 ].priority < entry.priority)
+			{
+				table [ index ] = table [ index - 1 ];
+				index--;
+			}
+			table [ index ] = entry;
+		}
+		return table;
+	} ();
+
+	static_assert ( [] ()
+	{
+		for ( uint8_t index = 1; index < count; index++ )
+		{
+			for ( uint8_t other = 0; other < index; other++ )
+			{
+				if (table [ index ].stack == table [ other ].stack)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	} (), "a TaskSpec used twice would share its stack" );
+
+	/*!
+	 * @brief Handle of a task of the set, known at compile time
+	 *
+	 * @param Body body of the task
+	 * @retval handle the task gets from create
+	 */
+	template<void (*Body) ( )>
+	static constexpr rtos_task_handle_t handle ( void )
+	{
+		constexpr rtos_task_handle_t found = find ( Body );
+		static_assert ( found >= 0,
+				"the body is missing from the task set or used twice" );
+		return found;
+	}
+
+	/*!
+	 * @brief Creates the tasks in table order, it must run before any
+	 * other task is created
+	 *
+	 * @param none
+	 * @retval 1 if every task got the handle of its table entry
+	 */
+	static uint8_t create ( void )
+	{
+		uint8_t retval = 1;
+		for ( uint8_t index = 0; index < count; index++ )
+		{
+			if (rtos_create_static_task ( table [ index ].body,
+					table [ index ].priority, table [ index ].autostart,
+					table [ index ].stack, table [ index ].stack_words ) != index)
+			{
+				retval = 0;
+			}
+		}
+		return retval;
+	}
+
+private:
+	//a body used twice would make its handle ambiguous
+	static constexpr rtos_task_handle_t find ( void (*body) ( ) )
+	{
+		rtos_task_handle_t found = -1;
+		for ( uint8_t index = 0; index < count; index++ )
+		{
+			if (table [ index ].body == body)
+			{
+				found = -1 == found ? index : -2;
+			}
+		}
+		return found;
+	}
+};
+
+}
+
+#endif /* SOURCE_RTOS_TASK_SET_HPP_ */
@@ -0,0 +1,250 @@
+/**
+ * @file rtos_timer.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of rtos software timers
+ *
+ * The timing wheel has RTOS_TIMER_WHEEL_LEVELS levels of
+ * 2^RTOS_TIMER_WHEEL_BITS slots. A timer goes to the lowest level
+ * that can hold its distance to expiry; the higher level slots are
+ * cascaded down each time the level below wraps.
+ */
+
+#include "rtos_timer.h"
+#include "rtos_kernel.h"
+
+#ifdef RTOS_ENABLE_SOFTWARE_TIMERS
+
+/**********************************************************************************/
+// Module defines
+/**********************************************************************************/
+
+#define WHEEL_SLOTS			(1 << RTOS_TIMER_WHEEL_BITS)
+#define WHEEL_MASK			(WHEEL_SLOTS - 1)
+#define LEVEL_SHIFT(level)	((level) * RTOS_TIMER_WHEEL_BITS)
+#define LEVEL_INDEX(tick, level)	\
+	((uint32_t) ( (tick) >> LEVEL_SHIFT(level) ) & WHEEL_MASK)
+#define WHEEL_SPAN			\
+	(( rtos_tick_t ) 1 << LEVEL_SHIFT(RTOS_TIMER_WHEEL_LEVELS))
+
+/**********************************************************************************/
+// Timer wheel
+/**********************************************************************************/
+
+static struct
+{
+	rtos_tick_t tick;	//next tick to be processed
+	rtos_timer_t *slots [ RTOS_TIMER_WHEEL_LEVELS ] [ WHEEL_SLOTS ];
+	rtos_timer_t *expired;	//timers waiting for their callback
+} timer_wheel =
+{ 0 };
+
+/**********************************************************************************/
+// Local methods prototypes
+/**********************************************************************************/
+
+static void
+timer_link ( rtos_timer_t **head, rtos_timer_t *timer );
+static void
+timer_unlink ( rtos_timer_t *timer );
+static void
+timer_insert ( rtos_timer_t *timer );
+static uint32_t
+timer_cascade ( uint8_t level );
+static void
+timer_task ( void );
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+void rtos_timer_init ( rtos_timer_t *timer, rtos_timer_callback_t callback,
+		void *arg, rtos_tick_t period, rtos_timer_mode_e mode )
+{
+	timer->next = 0;
+	timer->pprev = 0;
+	timer->expiry = 0;
+	timer->period = period;
+	timer->callback = callback;
+	timer->arg = arg;
+	timer->mode = mode;
+	timer->active = 0;
+}
+
+void rtos_timer_start ( rtos_timer_t *timer )
+{
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	timer_unlink ( timer );
+	timer->expiry = rtos_get_clock () + timer->period;
+	timer->active = 1;
+	timer_insert ( timer );
+	rtos_kernel_exit_critical ( critical );
+}
+
+void rtos_timer_stop ( rtos_timer_t *timer )
+{
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	timer_unlink ( timer );
+	timer->active = 0;
+	rtos_kernel_exit_critical ( critical );
+}
+
+void rtos_timer_change_period ( rtos_timer_t *timer, rtos_tick_t period )
+{
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	timer->period = period;
+	rtos_timer_start ( timer );
+	rtos_kernel_exit_critical ( critical );
+}
+
+uint8_t rtos_timer_is_active ( rtos_timer_t *timer )
+{
+	return timer->active;
+}
+
+/**********************************************************************************/
+// Kernel services implementation
+/**********************************************************************************/
+
+void rtos_timer_service_init ( void )
+{
+	rtos_create_task ( timer_task, RTOS_TIMER_TASK_PRIORITY, kAutoStart );
+}
+
+//Runs in the SysTick ISR, moves the timers of the current tick to the
+//expired list and wakes the timer task when there is work for it. The
+//wheel is shared with the timer API on the other cores, so it is walked
+//in the critical section; the callbacks run later in the timer task
+void rtos_timer_service_tick ( void )
+{
+	rtos_tick_t now = rtos_get_clock ();
+	rtos_critical_t critical = rtos_kernel_enter_critical ();
+	while (timer_wheel.tick <= now)
+	{
+		uint32_t index = LEVEL_INDEX( timer_wheel.tick, 0 );
+		for ( uint8_t level = 1; !index && level < RTOS_TIMER_WHEEL_LEVELS;
+				level++ )
+		{
+			index = timer_cascade ( level );
+		}
+		index = LEVEL_INDEX( timer_wheel.tick, 0 );
+		while (timer_wheel.slots [ 0 ] [ index ])
+		{
+			rtos_timer_t *timer = timer_wheel.slots [ 0 ] [ index ];
+			timer_unlink ( timer );
+			timer_link ( &timer_wheel.expired, timer );
+		}
+		timer_wheel.tick++;
+	}
+	if (timer_wheel.expired)
+	{
+		rtos_kernel_wake ( &timer_wheel.expired, 0 );
+	}
+	rtos_kernel_exit_critical ( critical );
+}
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+static void timer_link ( rtos_timer_t **head, rtos_timer_t *timer )
+{
+	timer->next = *head;
+	if (*head)
+	{
+		( *head )->pprev = &timer->next;
+	}
+	timer->pprev = head;
+	*head = timer;
+}
+
+static void timer_unlink ( rtos_timer_t *timer )
+{
+	if (timer->pprev)
+	{
+		*timer->pprev = timer->next;
+		if (timer->next)
+		{
+			timer->next->pprev = timer->pprev;
+		}
+		timer->next = 0;
+		timer->pprev = 0;
+	}
+}
+
+//Places the timer in the lowest level able to hold its distance to expiry,
+//timers beyond the wheel span are parked in the last slot and re-inserted
+//when they get cascaded
+static void timer_insert ( rtos_timer_t *timer )
+{
+	rtos_tick_t expiry = timer->expiry;
+	uint8_t level = 0;
+	if (expiry < timer_wheel.tick)
+	{
+		expiry = timer_wheel.tick;
+	}
+	else if (expiry - timer_wheel.tick >= WHEEL_SPAN)
+	{
+		expiry = timer_wheel.tick + WHEEL_SPAN - 1;
+	}
+	while (level < RTOS_TIMER_WHEEL_LEVELS - 1
+			&& expiry - timer_wheel.tick >= ( rtos_tick_t ) 1
+					<< LEVEL_SHIFT(level + 1))
+	{
+		level++;
+	}
+	timer_link ( &timer_wheel.slots [ level ] [ LEVEL_INDEX( expiry, level ) ],
+			timer );
+}
+
+//Moves the timers of the current slot of a level to the levels below,
+//returns the slot index so the caller knows if the next level wraps too
+static uint32_t timer_cascade ( uint8_t level )
+{
+	uint32_t index = LEVEL_INDEX( timer_wheel.tick, level );
+	rtos_timer_t *timer = timer_wheel.slots [ level ] [ index ];
+	timer_wheel.slots [ level ] [ index ] = 0;
+	while (timer)
+	{
+		rtos_timer_t *next = timer->next;
+		timer->next = 0;
+		timer->pprev = 0;
+		timer_insert ( timer );
+		timer = next;
+	}
+	return index;
+}
+
+/**********************************************************************************/
+// TIMER TASK
+/**********************************************************************************/
+
+static void timer_task ( void )
+{
+	for ( ;; )
+	{
+		rtos_critical_t critical = rtos_kernel_enter_critical ();
+		rtos_timer_t *timer = timer_wheel.expired;
+		if (!timer)
+		{
+			rtos_kernel_block ( &timer_wheel.expired, RTOS_WAIT_FOREVER,
+					critical );
+			continue;
+		}
+		timer_unlink ( timer );
+		if (kTimerAutoReload == timer->mode && timer->period)
+		{
+			//reload from the expiry, not from now, so periods do not drift
+			timer->expiry += timer->period;
+			timer_insert ( timer );
+		}
+		else
+		{
+			timer->active = 0;
+		}
+		rtos_kernel_exit_critical ( critical );
+		timer->callback ( timer, timer->arg );
+	}
+}
+
+#endif
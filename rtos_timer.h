@@ -0,0 +1,92 @@
+/**
+ * @file rtos_timer.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos software timers API
+ *
+ * One-shot and auto-reload software timers. Timers are kept in a
+ * hierarchical timing wheel advanced by the SysTick, so starting,
+ * stopping and expiring a timer is O(1). The callbacks run in the
+ * timer task, never in the ISR.
+ */
+
+#ifndef SOURCE_RTOS_TIMER_H_
+#define SOURCE_RTOS_TIMER_H_
+
+#include "rtos.h"
+#include "rtos_config.h"
+
+/*! @brief Timer mode type */
+typedef enum
+{
+	kTimerOneShot, kTimerAutoReload
+} rtos_timer_mode_e;
+
+/*! @brief Software timer type, allocated by the application */
+typedef struct rtos_timer rtos_timer_t;
+
+/*! @brief Timer callback type, runs in the timer task */
+typedef void (*rtos_timer_callback_t) ( rtos_timer_t *timer, void *arg );
+
+/*! @brief Software timer, its fields are private to the timer module */
+struct rtos_timer
+{
+	rtos_timer_t *next;
+	rtos_timer_t **pprev;	//link pointing to this timer, 0 if unlinked
+	rtos_tick_t expiry;
+	rtos_tick_t period;
+	rtos_timer_callback_t callback;
+	void *arg;
+	rtos_timer_mode_e mode;
+	uint8_t active;
+};
+
+/*!
+ * @brief Initializes a stopped timer
+ *
+ * @param timer timer to initialize
+ * @param callback function called on each expiry
+ * @param arg argument given to the callback
+ * @param period ticks from start to expiry, and between reloads
+ * @param mode either one shot or auto reload
+ * @retval none
+ */
+void rtos_timer_init ( rtos_timer_t *timer, rtos_timer_callback_t callback,
+		void *arg, rtos_tick_t period, rtos_timer_mode_e mode );
+
+/*!
+ * @brief Starts the timer, restarting it if it was already active.
+ * It can be called from ISRs and from timer callbacks
+ *
+ * @param timer timer to start
+ * @retval none
+ */
+void rtos_timer_start ( rtos_timer_t *timer );
+
+/*!
+ * @brief Stops the timer, a pending expiry is discarded. It can be
+ * called from ISRs and from timer callbacks
+ *
+ * @param timer timer to stop
+ * @retval none
+ */
+void rtos_timer_stop ( rtos_timer_t *timer );
+
+/*!
+ * @brief Changes the period of the timer and restarts it
+ *
+ * @param timer timer to change
+ * @param period new period in ticks
+ * @retval none
+ */
+void rtos_timer_change_period ( rtos_timer_t *timer, rtos_tick_t period );
+
+/*!
+ * @brief Tells whether the timer is running or waiting for its callback
+ *
+ * @param timer timer to check
+ * @retval 1 if active, else 0
+ */
+uint8_t rtos_timer_is_active ( rtos_timer_t *timer );
+
+#endif /* SOURCE_RTOS_TIMER_H_ */
@@ -0,0 +1,173 @@
+/**
+ * @file rtos_work.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of the rtos work queue
+ *
+ * The jobs are kept in a ring guarded by the kernel critical section,
+ * held only to copy a job in or a batch out. The workers block on the
+ * queue while it is empty, the submitters on its ring while it is full.
+ */
+
+#include "rtos_work.h"
+#include "rtos_kernel.h"
+
+#ifdef RTOS_ENABLE_WORK_QUEUE
+
+/**********************************************************************************/
+// Type definitions
+/**********************************************************************************/
+
+typedef struct
+{
+	rtos_work_function_t function;
+	void *arg;
+} work_job_t;
+
+/**********************************************************************************/
+// Work queue
+/**********************************************************************************/
+
+static struct
+{
+	work_job_t jobs [ RTOS_WORK_QUEUE_DEPTH ];
+	uint32_t head;
+	uint32_t count;
+	uint32_t high_water;
+	uint8_t sleeping;	//workers blocked and not yet woken
+	uint8_t waiters;	//submitters blocked on a full queue
+} work =
+{ 0 };
+
+/**********************************************************************************/
+// Local methods prototypes
+/**********************************************************************************/
+
+static void
+work_worker ( void );
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+uint8_t rtos_work_submit ( rtos_work_function_t function, void *arg,
+		rtos_tick_t timeout )
+{
+	rtos_tick_t deadline = rtos_get_clock () + timeout;
+	rtos_critical_t critical;
+	uint8_t woken = 0;
+	if (__get_IPSR ())
+	{
+		timeout = 0;
+	}
+	critical = rtos_kernel_enter_critical ();
+	while (RTOS_WORK_QUEUE_DEPTH == work.count)
+	{
+		if (!timeout)
+		{
+			rtos_kernel_exit_critical ( critical );
+			return 0;
+		}
+		work.waiters++;
+		if (!rtos_kernel_block ( work.jobs, timeout, critical ))
+		{
+			timeout = 0;
+		}
+		else if (RTOS_WAIT_FOREVER != timeout)
+		{
+			//another task took the room first, wait for the time left
+			rtos_tick_t now = rtos_get_clock ();
+			timeout = deadline > now ? deadline - now : 0;
+		}
+		critical = rtos_kernel_enter_critical ();
+		work.waiters--;
+	}
+	work.jobs [ ( work.head + work.count ) % RTOS_WORK_QUEUE_DEPTH ] =
+			( work_job_t )
+			{ function, arg };
+	work.count++;
+	if (work.count > work.high_water)
+	{
+		work.high_water = work.count;
+	}
+	//a batch for each awake worker before another one is woken
+	if (work.sleeping
+			&& work.count
+					> ( uint32_t ) ( RTOS_WORK_QUEUE_WORKERS - work.sleeping )
+							* RTOS_WORK_QUEUE_BATCH)
+	{
+		work.sleeping--;
+		woken = rtos_kernel_wake ( &work, 0 );
+	}
+	rtos_kernel_exit_critical ( critical );
+	if (woken)
+	{
+		rtos_kernel_yield ();
+	}
+	return 1;
+}
+
+uint32_t rtos_work_get_pending ( void )
+{
+	return work.count;
+}
+
+uint32_t rtos_work_get_high_water ( void )
+{
+	return work.high_water;
+}
+
+/**********************************************************************************/
+// Kernel services implementation
+/**********************************************************************************/
+
+void rtos_work_queue_init ( void )
+{
+	for ( uint8_t worker = 0; worker < RTOS_WORK_QUEUE_WORKERS; worker++ )
+	{
+		rtos_create_task ( work_worker, RTOS_WORK_QUEUE_PRIORITY, kAutoStart );
+	}
+}
+
+/**********************************************************************************/
+// Local methods implementation
+/**********************************************************************************/
+
+//Body of the workers, the batch is copied out so the queue is free while its jobs run
+static void work_worker ( void )
+{
+	work_job_t batch [ RTOS_WORK_QUEUE_BATCH ];
+	for ( ;; )
+	{
+		rtos_critical_t critical = rtos_kernel_enter_critical ();
+		uint8_t taken = 0;
+		uint8_t woken = 0;
+		if (!work.count)
+		{
+			work.sleeping++;
+			rtos_kernel_block ( &work, RTOS_WAIT_FOREVER, critical );
+			continue;
+		}
+		while (work.count && taken < RTOS_WORK_QUEUE_BATCH)
+		{
+			batch [ taken++ ] = work.jobs [ work.head ];
+			work.head = ( work.head + 1 ) % RTOS_WORK_QUEUE_DEPTH;
+			work.count--;
+		}
+		if (work.waiters)
+		{
+			woken = rtos_kernel_wake ( work.jobs, 1 );
+		}
+		rtos_kernel_exit_critical ( critical );
+		if (woken)
+		{
+			rtos_kernel_yield ();
+		}
+		for ( uint8_t job = 0; job < taken; job++ )
+		{
+			batch [ job ].function ( batch [ job ].arg );
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * @file rtos_work.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos work queue API
+ *
+ * Short jobs, a function and its argument, are queued by tasks and
+ * ISRs and run by a pool of RTOS_WORK_QUEUE_WORKERS kernel tasks at
+ * RTOS_WORK_QUEUE_PRIORITY, instead of one task and stack for each
+ * kind of job. A worker takes up to RTOS_WORK_QUEUE_BATCH jobs at once
+ * and runs them back to back, without a context switch in between;
+ * the workers block while the queue is empty. A sleeping worker is only
+ * woken when the awake ones already have a full batch each.
+ *
+ * Jobs start in submission order but, with more than one worker, may
+ * overlap. A job may block, but that holds its worker and the jobs
+ * queued for it.
+ */
+
+#ifndef SOURCE_RTOS_WORK_H_
+#define SOURCE_RTOS_WORK_H_
+
+#include "rtos.h"
+#include "rtos_config.h"
+
+#ifdef RTOS_ENABLE_WORK_QUEUE
+
+/*! @brief Job function type, runs in a worker task */
+typedef void (*rtos_work_function_t) ( void *arg );
+
+/*!
+ * @brief Queues a job for the workers. From ISRs the timeout must be 0
+ *
+ * @param function function to run
+ * @param arg argument given to the function
+ * @param timeout ticks to wait for room in the queue, 0 to return at
+ * once, or RTOS_WAIT_FOREVER
+ * @retval 1 if queued, 0 if the queue stayed full until the timeout
+ */
+uint8_t rtos_work_submit ( rtos_work_function_t function, void *arg,
+		rtos_tick_t timeout );
+
+/*!
+ * @brief Returns the number of jobs queued and not yet taken by a worker
+ *
+ * @param none
+ * @retval jobs pending
+ */
+uint32_t rtos_work_get_pending ( void );
+
+/*!
+ * @brief Returns the highest number of jobs ever queued at once
+ *
+ * @param none
+ * @retval high-water mark in jobs
+ */
+uint32_t rtos_work_get_high_water ( void );
+
+#endif
+
+#endif /* SOURCE_RTOS_WORK_H_ */
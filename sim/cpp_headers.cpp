@@ -0,0 +1,56 @@
+/**
+ * @file cpp_headers.cpp
+ * @author ITESO
+ * @date Oct 2026
+ * @brief The C++ headers of the rtos included together
+ *
+ * Only compiled, by "make headers", so a name clash between rtos.hpp,
+ * rtos_task_set.hpp and rtos_coroutine.hpp breaks the build. It uses
+ * each of them once.
+ */
+
+#include "rtos.hpp"
+#include "rtos_task_set.hpp"
+#include "rtos_coroutine.hpp"
+
+#include <mutex>
+
+static rtos::Mutex mutex;
+static rtos::Queue<uint32_t, 4> queue;
+static rtos::CoroutineRunner runner;
+
+static rtos::Coroutine blink ( void )
+{
+	for ( ;; )
+	{
+		co_await rtos::delay ( 500 );
+	}
+}
+
+static void runner_task ( void )
+{
+	runner.run ();
+}
+
+static void producer_task ( void )
+{
+	for ( ;; )
+	{
+		{
+			std::lock_guard<rtos::Mutex> lock ( mutex );
+		}
+		queue.push ( 1 );
+		rtos::Task::delay ( std::chrono::milliseconds ( 10 ) );
+	}
+}
+
+using Tasks = rtos::TaskSet<
+		rtos::TaskSpec<runner_task, 2>,
+		rtos::TaskSpec<producer_task, 1, 64>>;
+
+void cpp_headers_start ( void )
+{
+	runner.spawn ( blink (), 1 );
+	Tasks::create ();
+	rtos::Task ( Tasks::handle<producer_task> () ).activate ();
+}
@@ -0,0 +1,38 @@
+/**
+ * @file fsl_common.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Host stand-in of the SDK header for the simulation
+ *
+ * Only the CMSIS intrinsics the rtos headers call, enough to compile
+ * them on the host. The interrupt mask is a plain variable.
+ */
+
+#ifndef SIM_FSL_COMMON_H_
+#define SIM_FSL_COMMON_H_
+
+#include <stdint.h>
+
+static uint32_t sim_primask;
+
+static inline uint32_t __get_PRIMASK ( void )
+{
+	return sim_primask;
+}
+
+static inline void __set_PRIMASK ( uint32_t primask )
+{
+	sim_primask = primask;
+}
+
+static inline void __disable_irq ( void )
+{
+	sim_primask = 1;
+}
+
+static inline uint32_t __get_IPSR ( void )
+{
+	return 0;
+}
+
+#endif /* SIM_FSL_COMMON_H_ */
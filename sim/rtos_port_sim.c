@@ -0,0 +1,59 @@
+/**
+ * @file rtos_port_sim.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Implementation of the rtos SMP port for the host simulation
+ */
+
+#include "rtos_port_sim.h"
+#include <pthread.h>
+
+/**********************************************************************************/
+// Port data
+/**********************************************************************************/
+
+static __thread uint8_t core_id;
+static pthread_spinlock_t locks [ RTOS_SMP_KERNEL_LOCK + 1 ];
+static uint8_t ipi_pending [ RTOS_NUMBER_OF_CORES ];
+
+/**********************************************************************************/
+// API implementation
+/**********************************************************************************/
+
+void sim_port_init ( void )
+{
+	for ( uint8_t lock = 0; lock <= RTOS_SMP_KERNEL_LOCK; lock++ )
+	{
+		pthread_spin_init ( &locks [ lock ], PTHREAD_PROCESS_PRIVATE );
+	}
+}
+
+void sim_port_set_core ( uint8_t core )
+{
+	core_id = core;
+}
+
+uint8_t sim_port_take_ipi ( void )
+{
+	return __atomic_exchange_n ( &ipi_pending [ core_id ], 0, __ATOMIC_ACQUIRE );
+}
+
+uint8_t rtos_port_core_id ( void )
+{
+	return core_id;
+}
+
+void rtos_port_send_ipi ( uint8_t core )
+{
+	__atomic_store_n ( &ipi_pending [ core ], 1, __ATOMIC_RELEASE );
+}
+
+void rtos_port_spin_lock ( uint8_t lock )
+{
+	pthread_spin_lock ( &locks [ lock ] );
+}
+
+void rtos_port_spin_unlock ( uint8_t lock )
+{
+	pthread_spin_unlock ( &locks [ lock ] );
+}
@@ -0,0 +1,40 @@
+/**
+ * @file rtos_port_sim.h
+ * @author ITESO
+ * @date Oct 2026
+ * @brief rtos SMP port for the host simulation
+ *
+ * Each simulated core is a pthread. The inter-core interrupts are
+ * flags the core polls between jobs.
+ */
+
+#ifndef SIM_RTOS_PORT_SIM_H_
+#define SIM_RTOS_PORT_SIM_H_
+
+#include "rtos_smp.h"
+
+/*!
+ * @brief Creates the spinlocks, call it before any core starts
+ *
+ * @param none
+ * @retval none
+ */
+void sim_port_init ( void );
+
+/*!
+ * @brief Binds the calling thread to a simulated core
+ *
+ * @param core core number
+ * @retval none
+ */
+void sim_port_set_core ( uint8_t core );
+
+/*!
+ * @brief Takes the pending inter-core interrupt of the calling core
+ *
+ * @param none
+ * @retval 1 if one was pending
+ */
+uint8_t sim_port_take_ipi ( void );
+
+#endif /* SIM_RTOS_PORT_SIM_H_ */
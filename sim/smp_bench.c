@@ -0,0 +1,133 @@
+/**
+ * @file smp_bench.c
+ * @author ITESO
+ * @date Oct 2026
+ * @brief Throughput of the SMP scheduler on the host simulation
+ *
+ * Every core runs jobs of a fixed length, after each one its task
+ * yields and is queued again, as the kernel does, under the kernel
+ * lock. As in the kernel, each core has an idle task pinned to it and
+ * always ready. Half of the other tasks are pinned to one core so the
+ * stealing and the affinity paths are exercised. Prints jobs per second
+ * and the picks that found only the idle task.
+ *
+ * Only the queues of rtos_smp.c are measured, not the dispatcher and the
+ * context switch of rtos.c. Each pick holds the kernel lock, as on the
+ * board, so the jobs per second do not grow with the cores.
+ */
+
+#include "rtos_port_sim.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**********************************************************************************/
+// Bench settings
+/**********************************************************************************/
+
+#define TASKS_PER_CORE		4
+#define JOB_LOOPS			2000
+#define RUN_SECONDS			2
+
+/**********************************************************************************/
+// Bench data
+/**********************************************************************************/
+
+static volatile uint8_t stop;
+static uint64_t jobs [ RTOS_NUMBER_OF_CORES ];
+static uint64_t ipis [ RTOS_NUMBER_OF_CORES ];
+static uint64_t idles [ RTOS_NUMBER_OF_CORES ];
+
+/**********************************************************************************/
+// Local methods
+/**********************************************************************************/
+
+static void job ( void )
+{
+	volatile uint32_t sink = 0;
+	for ( uint32_t loop = 0; loop < JOB_LOOPS; loop++ )
+	{
+		sink += loop;
+	}
+}
+
+static void *core_thread ( void *arg )
+{
+	uint8_t core = ( uint8_t ) ( uintptr_t ) arg;
+	rtos_task_handle_t current = -1;
+	sim_port_set_core ( core );
+	while (!stop)
+	{
+		rtos_task_handle_t next;
+		ipis [ core ] += sim_port_take_ipi ();
+		rtos_port_spin_lock ( RTOS_SMP_KERNEL_LOCK );
+		next = rtos_smp_pick ( core, current, 0 );
+		if (-1 != current)
+		{
+			rtos_smp_ready ( current );
+		}
+		rtos_port_spin_unlock ( RTOS_SMP_KERNEL_LOCK );
+		current = next;
+		if (current < RTOS_NUMBER_OF_CORES)
+		{
+			//the idle task of the core, the tasks ready elsewhere were not stolen
+			idles [ core ]++;
+		}
+		else
+		{
+			job ();
+			jobs [ core ]++;
+		}
+	}
+	return NULL;
+}
+
+/**********************************************************************************/
+// Main
+/**********************************************************************************/
+
+int main ( void )
+{
+	pthread_t threads [ RTOS_NUMBER_OF_CORES ];
+	uint64_t total = 0;
+	sim_port_init ();
+	//the first handles are the idle tasks, one pinned to each core
+	for ( uint8_t core = 0; core < RTOS_NUMBER_OF_CORES; core++ )
+	{
+		rtos_smp_add_task ( core, 0 );
+		rtos_smp_set_affinity ( core, ( rtos_affinity_t ) 1 << core );
+		rtos_smp_ready ( core );
+	}
+	for ( rtos_task_handle_t task = RTOS_NUMBER_OF_CORES;
+			task < ( TASKS_PER_CORE + 1 ) * RTOS_NUMBER_OF_CORES
+					&& task <= RTOS_MAX_NUMBER_OF_TASKS; task++ )
+	{
+		rtos_smp_add_task ( task, 1 + task % 3 );
+		if (task % 2)
+		{
+			rtos_smp_set_affinity ( task, ( rtos_affinity_t ) 1
+					<< ( task / 2 % RTOS_NUMBER_OF_CORES ) );
+		}
+		rtos_smp_ready ( task );
+	}
+	for ( uint8_t core = 0; core < RTOS_NUMBER_OF_CORES; core++ )
+	{
+		pthread_create ( &threads [ core ], NULL, core_thread,
+				( void * ) ( uintptr_t ) core );
+	}
+	sleep ( RUN_SECONDS );
+	stop = 1;
+	for ( uint8_t core = 0; core < RTOS_NUMBER_OF_CORES; core++ )
+	{
+		pthread_join ( threads [ core ], NULL );
+		total += jobs [ core ];
+		printf ( "core %u: %llu jobs, %llu idle picks, %llu ipis\n", core,
+				( unsigned long long ) jobs [ core ],
+				( unsigned long long ) idles [ core ],
+				( unsigned long long ) ipis [ core ] );
+	}
+	printf ( "%u cores: %llu jobs/s\n", RTOS_NUMBER_OF_CORES,
+			( unsigned long long ) total / RUN_SECONDS );
+	return 0;
+}